@@ -14,10 +14,21 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <sstream>                // For formatted errors
 #include <stdexcept>              // Standard exceptions
 #include <system_error>           // Error codes
+#include <chrono>                 // Measuring the solve time
+#include <cmath>                  // Distance to bounds
+#include <algorithm>              // Checking variable names
+#include <cctype>                 // Identifier characters
+#include <vector>                 // Configuration variables
+#include <optional>               // Incumbent objective value
+#include <utility>                // Variable names and values
+#include <regex>                  // Integer variable declarations
+#include <functional>             // Scope guard actions
 
 #include "Utility/ConsolePrint.hpp"
 
 #include "AMPLSolver.hpp"
+#include "ConfigurationEnumerator.hpp"
+#include "MetricSnapshotStore.hpp"
 
 namespace NebulOuS
 {
@@ -26,6 +37,43 @@ namespace NebulOuS
 // Utility functions
 // -----------------------------------------------------------------------------
 //
+// The changes made to the AMPL problem for one solve must be undone also if
+// the solve throws, and a scope guard undoes the changes when it goes out of
+// scope. The guard must not throw while an exception is propagating, and an
+// error in undoing the changes is only reported.
+
+namespace
+{
+class ScopeGuard
+{
+private:
+
+  const std::function< void( void ) > Undo;
+
+public:
+
+  ScopeGuard( std::function< void( void ) > TheUndo )
+  : Undo( std::move( TheUndo ) )
+  {}
+
+  ScopeGuard( const ScopeGuard & Other ) = delete;
+
+  ~ScopeGuard( void )
+  {
+    try
+    {
+      Undo();
+    }
+    catch( const std::exception & TheError )
+    {
+      Theron::ConsoleOutput Output;
+      Output << "AMPL Solver: The problem could not be restored: " 
+             << TheError.what() << std::endl;
+    }
+  }
+};
+}
+
 // There are two situations when it is necessary to store a file from a message:
 // Firstly when the AMPL model is defined, and second every time a data file 
 // is received updating AMPL model parameters. Hence the common file creation
@@ -108,6 +156,397 @@ void AMPLSolver::SetAMPLParameter( const std::string & ParameterName,
   }
 }
 
+// The solver name is taken as the stem of the given solver in case the 
+// solver is given with its full path. Other options in the option string are 
+// kept in the order they were given.
+
+bool AMPLSolver::SetSolverOption( 
+  const std::map< std::string, std::string > & OptionNames,
+  const std::string & TheValue )
+{
+  std::string TheSolver 
+              = std::filesystem::path( SolverName ).stem().string();
+
+  if( !OptionNames.contains( TheSolver ) ) return false;
+
+  std::string OptionName = TheSolver + "_options",
+              TheOption  = OptionNames.at( TheSolver ) + "=";
+
+  ampl::Optional< std::string > 
+  CurrentOptions = ProblemDefinition.getOption( OptionName.c_str() );
+
+  std::istringstream OldOptions( CurrentOptions ? CurrentOptions.value() 
+                                                : std::string() );
+  std::ostringstream NewOptions;
+  std::string        AnOption;
+
+  while( OldOptions >> AnOption )
+    if( !AnOption.starts_with( TheOption ) )
+      NewOptions << AnOption << " ";
+
+  NewOptions << TheOption << TheValue;
+
+  ProblemDefinition.setOption( OptionName.c_str(), NewOptions.str() );
+  return true;
+}
+
+// The name of the thread option is the same for the commonly used 
+// multi-threaded solvers.
+
+void AMPLSolver::SetThreadOption( void )
+{
+  static const std::map< std::string, std::string > ThreadOptions{
+    {"highs", "threads"}, {"cbc", "threads"}, {"gurobi", "threads"}, 
+    {"xpress", "threads"}, {"cplex", "threads"}
+  };
+
+  if( ThreadLimit > 0 )
+    SetSolverOption( ThreadOptions, std::to_string( ThreadLimit ) );
+}
+
+// -----------------------------------------------------------------------------
+// Tightened bounds
+// -----------------------------------------------------------------------------
+//
+// Only scalar variables with plain names can be bounded since the names of the
+// auxiliary entities are derived from the variable name. The auxiliary 
+// parameters and the range constraint are declared the first time a variable
+// is bounded, and the constraint is restored every time the variable is 
+// bounded since it is dropped after each solve.
+
+bool AMPLSolver::TightenBounds( const Solver::MetricValueType & TheBounds )
+{
+  bool Tightened = false;
+
+  for( auto Variable : ProblemDefinition.getVariables() )
+  {
+    std::string TheName( Variable.name() );
+    auto TheBound = TheBounds.find( TheName );
+
+    if( ( TheBound == TheBounds.end() ) || !TheBound->second.is_array() ||
+        ( TheBound->second.size() != 2 ) ||
+        !std::ranges::all_of( TheName, []( unsigned char C ){
+           return std::isalnum( C ) || ( C == '_' ); } ) )
+      continue;
+
+    if( !BoundedVariables.contains( TheName ) )
+    {
+      ProblemDefinition.eval( 
+        "param NebulOuS_Lower_" + TheName + "; "
+        "param NebulOuS_Upper_" + TheName + "; "
+        "subject to NebulOuS_Bound_" + TheName + ": NebulOuS_Lower_" + TheName
+        + " <= " + TheName + " <= NebulOuS_Upper_" + TheName + ";" );
+
+      BoundedVariables.insert( TheName );
+    }
+
+    SetAMPLParameter( "NebulOuS_Lower_" + TheName, TheBound->second[ 0 ] );
+    SetAMPLParameter( "NebulOuS_Upper_" + TheName, TheBound->second[ 1 ] );
+    ProblemDefinition.getConstraint( "NebulOuS_Bound_" + TheName ).restore();
+
+    Tightened = true;
+  }
+
+  return Tightened;
+}
+
+// A variable is taken to be on a bound if it is within a small relative 
+// tolerance of the bound since the back-end solvers only satisfy the bounds
+// to within their feasibility tolerance.
+
+bool AMPLSolver::OnTightenedBound( const Solver::MetricValueType & TheBounds )
+{
+  for( auto Variable : ProblemDefinition.getVariables() )
+    if( BoundedVariables.contains( Variable.name() ) &&
+        TheBounds.contains( Variable.name() ) )
+    {
+      double Value = Variable.value();
+
+      for( const JSON & TheBound : TheBounds.at( Variable.name() ) )
+      {
+        double Bound = TheBound.get< double >();
+
+        if( std::fabs( Value - Bound ) 
+            <= 1e-6 * std::max( 1.0, std::fabs( Bound ) ) )
+          return true;
+      }
+    }
+
+  return false;
+}
+
+void AMPLSolver::RelaxBounds( void )
+{
+  for( const std::string & TheName : BoundedVariables )
+    ProblemDefinition.getConstraint( "NebulOuS_Bound_" + TheName ).drop();
+}
+
+// -----------------------------------------------------------------------------
+// Neighbourhood search
+// -----------------------------------------------------------------------------
+//
+// The incumbent is first the deployed configuration with only the other 
+// variables optimised, and a configuration found for a subset of free 
+// variables is accepted if it is strictly better than the incumbent. If the
+// last problem solved did not give the incumbent, the variable values of the
+// incumbent are set back so that the objective values and the variable 
+// values read after the search are those of the incumbent.
+
+int AMPLSolver::NeighbourhoodSearch( const std::string & OptimisationGoal,
+                                     double TimeLimit )
+{
+  using Clock = std::chrono::steady_clock;
+
+  auto Deadline = Clock::now() 
+    + std::chrono::duration_cast< Clock::duration >( 
+        std::chrono::duration< double >( TimeLimit ) );
+
+  // The configuration variables are ordered with the variables most likely to
+  // change first. The deployed values are read from the constants.
+
+  std::vector< std::pair< std::string, double > > Configuration;
+
+  for( auto Variable : ProblemDefinition.getVariables() )
+    if( auto TheConstant = VariablesToConstants.find( Variable.name() );
+        TheConstant != VariablesToConstants.end() )
+      Configuration.emplace_back( Variable.name(), 
+        ProblemDefinition.getValue( TheConstant->second ).dbl() );
+
+  if( Configuration.empty() )
+  {
+    Optimize();
+    return SolveResult();
+  }
+
+  std::ranges::stable_sort( Configuration, std::ranges::greater(),
+    [this]( const auto & TheVariable ){
+      auto TheRate = ChangeRates.find( TheVariable.first );
+      return TheRate == ChangeRates.end() ? 0.0 : TheRate->second; } );
+
+  // Utility functions to fix all but the first variables, to test if the 
+  // last solve found a solution, and to compare objective values in the 
+  // direction of the objective.
+
+  auto FreeVariables = [&]( std::size_t Free ){
+    for( std::size_t i = 0; i < Configuration.size(); i++ )
+      if( i < Free )
+        ProblemDefinition.getVariable( Configuration[i].first ).unfix();
+      else
+        ProblemDefinition.getVariable( Configuration[i].first ).fix( 
+          Configuration[i].second );
+  };
+
+  // The time left is set as the time limit of the back-end solver before 
+  // each solve. The option string of the solver is saved first, and it is 
+  // restored with all configuration variables free when the search ends. 
+  // The time limit option is the same for the solvers built on the AMPL 
+  // MP library, while Couenne and Bonmin take the Bonmin time limit, and 
+  // Ipopt its own limit on the processing time.
+
+  static const std::map< std::string, std::string > TimeOptions{
+    {"highs", "lim:time"}, {"cbc", "lim:time"}, {"gurobi", "lim:time"}, 
+    {"xpress", "lim:time"}, {"cplex", "lim:time"}, 
+    {"couenne", "bonmin.time_limit"}, {"bonmin", "bonmin.time_limit"},
+    {"ipopt", "max_cpu_time"}
+  };
+
+  std::string OptionName = std::filesystem::path( SolverName ).stem().string()
+                         + "_options";
+  ampl::Optional< std::string > 
+  SavedOptions = ProblemDefinition.getOption( OptionName.c_str() );
+
+  ScopeGuard RestoreProblem( [&]( void ){
+    FreeVariables( Configuration.size() );
+    ProblemDefinition.setOption( OptionName.c_str(), 
+      SavedOptions ? SavedOptions.value() : std::string() );
+  });
+
+  auto SetTimeLimit = [&]( void ){
+    std::chrono::duration< double > TimeLeft 
+      = std::max( Deadline - Clock::now(), Clock::duration::zero() );
+    return SetSolverOption( TimeOptions, std::to_string( TimeLeft.count() ) );
+  };
+
+  auto Solved = [this]( void ){ return SolveResult() < 200; };
+
+  auto Objective = ProblemDefinition.getObjective( OptimisationGoal );
+
+  auto Better = [&]( double Value, double Incumbent ){
+    double Tolerance = 1e-9 * std::max( 1.0, std::fabs( Incumbent ) );
+    return Objective.minimization() ? Value < Incumbent - Tolerance 
+                                    : Value > Incumbent + Tolerance; };
+
+  std::optional< double > Incumbent;
+  std::map< std::string, double > IncumbentValues;
+  int IncumbentResult = 0;
+
+  auto Record = [&]( void ){
+    Incumbent = Objective.value();
+    IncumbentResult = SolveResult();
+    IncumbentValues.clear();
+    for( auto Variable : ProblemDefinition.getVariables() )
+      IncumbentValues.emplace( Variable.name(), Variable.value() );
+  };
+
+  FreeVariables( 0 );
+  bool TimeLimited = SetTimeLimit();
+
+  if( !TimeLimited )
+  {
+    Theron::ConsoleOutput Output;
+    Output << "AMPL Solver: The solver " << SolverName << " cannot be limited "
+           << "in time, and the neighbourhood search may exceed its time "
+           << "limit of " << TimeLimit << " seconds" << std::endl;
+  }
+
+  Optimize();
+
+  if( Solved() ) Record();
+
+  // The neighbourhood is grown until a better configuration is found. The 
+  // last configuration variable is never freed if the solves cannot be 
+  // limited in time.
+
+  std::size_t MaxFree   = TimeLimited ? Configuration.size() 
+                                      : Configuration.size() - 1,
+              FirstSize = std::clamp< std::size_t >( NeighbourhoodSize, 1, 
+                                                     std::max< std::size_t >( 
+                                                       MaxFree, 1 ) ),
+              Free      = FirstSize;
+  bool Improved = false, LastIsIncumbent = Incumbent.has_value();
+
+  while( !Improved && ( Free <= MaxFree ) && ( Clock::now() < Deadline ) )
+  {
+    FreeVariables( Free );
+    SetTimeLimit();
+    Optimize();
+
+    if( Solved() && ( !Incumbent || Better( Objective.value(), *Incumbent ) ) )
+    {
+      Record();
+      Improved = LastIsIncumbent = true;
+    }
+    else if( Free == MaxFree ) 
+    {
+      LastIsIncumbent = false;
+      break;
+    }
+    else
+    {
+      LastIsIncumbent = false;
+      Free = std::min( 2 * Free, MaxFree );
+    }
+  }
+
+  // The change rates of the freed variables and the size of the first 
+  // neighbourhood are updated if a better configuration was found.
+
+  if( Improved )
+  {
+    for( std::size_t i = 0; i < Free; i++ )
+    {
+      double Deployed = Configuration[i].second,
+             Found    = IncumbentValues.at( Configuration[i].first );
+      bool   Changed  = std::fabs( Found - Deployed ) 
+                        > 1e-6 * std::max( 1.0, std::fabs( Deployed ) );
+
+      double & TheRate = ChangeRates[ Configuration[i].first ];
+      TheRate = 0.8 * TheRate + ( Changed ? 0.2 : 0.0 );
+    }
+
+    NeighbourhoodSize = ( Free == FirstSize ) 
+                      ? std::max< std::size_t >( Free / 2, 1 ) : Free;
+  }
+
+  if( !LastIsIncumbent && Incumbent )
+    for( auto Variable : ProblemDefinition.getVariables() )
+      Variable.setValue( IncumbentValues.at( Variable.name() ) );
+
+  Theron::ConsoleOutput Output;
+  Output << "AMPL Solver: Neighbourhood search with " << Free << " of " 
+         << Configuration.size() << " configuration variables free " 
+         << ( Improved ? "improved" : "did not improve" ) 
+         << " the deployed configuration" << std::endl;
+
+  return Incumbent ? IncumbentResult : SolveResult();
+}
+
+// -----------------------------------------------------------------------------
+// Exhaustive enumeration
+// -----------------------------------------------------------------------------
+//
+// The bounds are read for every context since they may depend on the metric
+// values, and the enumeration is abandoned as soon as the product of the 
+// domain sizes exceeds the maximum number of configurations. The constraints
+// are only expanded if the model has constraints. An infeasible problem is 
+// left to AMPL so that the solver reports the infeasibility in the usual way.
+
+bool AMPLSolver::EnumerateProblem( const std::string & OptimisationGoal )
+{
+  if( IntegerVariables.empty() ) return false;
+
+  // The bounds and the expanded problem are read from AMPL, and an AMPL 
+  // error, for instance for a model construct that cannot be expanded, only
+  // means that the problem must be solved by AMPL.
+
+  try
+  {
+    std::vector< ConfigurationEnumerator::Domain > Domains;
+    std::size_t Configurations = 1;
+
+    for( const std::string & TheName : IntegerVariables )
+    {
+      double Lower = ProblemDefinition.getValue( TheName + ".lb" ).dbl(),
+             Upper = ProblemDefinition.getValue( TheName + ".ub" ).dbl();
+
+      if( !std::isfinite( Lower ) || !std::isfinite( Upper ) ||
+          ( Upper - Lower >= static_cast< double >( MaxConfigurations ) ) )
+        return false;
+
+      ConfigurationEnumerator::Domain TheDomain{ TheName, 
+        static_cast< long >( std::ceil( Lower - 1e-9 ) ),
+        static_cast< long >( std::floor( Upper + 1e-9 ) ) };
+
+      if( TheDomain.Upper < TheDomain.Lower ) return false;
+
+      std::size_t Size = TheDomain.Upper - TheDomain.Lower + 1;
+
+      if( Size > MaxConfigurations / Configurations ) return false;
+
+      Configurations *= Size;
+      Domains.push_back( TheDomain );
+    }
+
+    std::string ExpandedProblem 
+      = ProblemDefinition.getOutput( "expand " + OptimisationGoal + ";" );
+
+    if( ProblemDefinition.getValue( "_ncons" ).dbl() > 0 )
+      ExpandedProblem += ProblemDefinition.getOutput( "expand _con;" );
+
+    ConfigurationEnumerator Enumerator( Domains );
+
+    if( !Enumerator.Compile( ExpandedProblem, OptimisationGoal ) ) return false;
+
+    auto Optimum = Enumerator.Optimum( std::max( ThreadLimit, 1u ) );
+
+    if( !Optimum ) return false;
+
+    for( std::size_t i = 0; i < Domains.size(); i++ )
+      ProblemDefinition.getVariable( Domains[i].Name ).setValue( 
+        static_cast< double >( (*Optimum)[i] ) );
+
+    return true;
+  }
+  catch( const std::exception & TheError )
+  {
+    Theron::ConsoleOutput Output;
+    Output << "AMPL Solver: The problem cannot be enumerated and it is solved "
+           << "by AMPL: " << TheError.what() << std::endl;
+
+    return false;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Problem definition
 // -----------------------------------------------------------------------------
@@ -146,11 +585,21 @@ void AMPLSolver::DefineProblem(const Solver::OptimisationProblem & TheProblem,
   // First storing the AMPL problem file from its definition in the message
   // and read the file back to the AMPL interpreter.
 
+  std::string ModelContent = TheProblem.at( 
+    OptimisationProblem::Keys::ProblemDescription ).get< std::string >();
+
   ProblemDefinition.read( SaveFile( 
     TheProblem.at( 
       OptimisationProblem::Keys::ProblemFile ).get< std::string >() ,
-    TheProblem.at( 
-      OptimisationProblem::Keys::ProblemDescription ).get< std::string >() ) );
+    ModelContent ) );
+
+  // The standard hash function may differ between builds and runs, and the 
+  // model version is therefore the 64-bit FNV-1a digest of the model text.
+
+  ModelVersion = 0xcbf29ce484222325ULL;
+
+  for( unsigned char Character : ModelContent )
+    ModelVersion = ( ModelVersion ^ Character ) * 0x100000001b3ULL;
 
   // The next is to read the label of the default objective function and 
   // store this. An invalid argument exception is thrown if the field is missing
@@ -212,6 +661,43 @@ void AMPLSolver::DefineProblem(const Solver::OptimisationProblem & TheProblem,
         ConstantRecord.at( OptimisationProblem::Keys::InitialConstantValue ) );
     }
 
+  // If the model may be solved by enumeration, the variables are checked to 
+  // be scalar integer or binary variables from their declarations. The list 
+  // of integer variables is left empty if any variable is not integral.
+
+  IntegerVariables.clear();
+
+  if( MaxConfigurations > 0 )
+  {
+    static const std::regex Integral( R"(\b(integer|binary)\b)" );
+
+    for( auto Variable : ProblemDefinition.getVariables() )
+      if( Variable.isScalar() && std::regex_search( 
+            ProblemDefinition.getOutput( "show " + Variable.name() + ";" ),
+            Integral ) )
+        IntegerVariables.push_back( Variable.name() );
+      else
+      {
+        IntegerVariables.clear();
+        break;
+      }
+  }
+
+  // The names of the parameters declared by the model are published so that
+  // the Metric Updater only tracks the metrics used by the model. There is no
+  // Metric Updater in batch mode where there is no network.
+
+  if( HasNetwork() )
+  {
+    std::vector< std::string > ParameterNames;
+
+    for( auto TheParameter : ProblemDefinition.getParameters() )
+      ParameterNames.push_back( TheParameter.name() );
+
+    Send( Solver::ModelParameters( ParameterNames ), 
+          Address( Solver::ModelParameters::AMQTopic ) );
+  }
+
   // Finally, the problem has been defined and the flag is set to allow 
   // the search for solutions for this problem.
 
@@ -254,18 +740,57 @@ void AMPLSolver::SolveProblem(
          << std::boolalpha << ProblemUndefined << std::endl
          << TheContext.dump(2) << std::endl;
 
-  // There is nothing to do if the application model is missing.
+  // The context cannot be solved if the application model is missing, and 
+  // the failure is returned with the model version like other solutions.
 
-  if( ProblemUndefined ) return;
+  try
+  {
+    if( ProblemUndefined )
+      throw std::logic_error( "No optimisation problem has been defined" );
+
+    SolveContext( TheContext, TheRequester );
+  }
+  catch( const std::exception & TheError )
+  {
+    Solver::Solution Failure( TheContext, TheError.what() );
+    Failure[ Solver::Solution::Keys::ModelVersion ] = ModelVersion;
+
+    Output << "AMPL Solver: The context could not be solved: " 
+           << TheError.what() << std::endl;
+
+    Send( Failure, TheRequester );
+  }
+}
+
+void AMPLSolver::SolveContext( 
+  const ApplicationExecutionContext & TheContext, const Address TheRequester )
+{
+  Theron::ConsoleOutput Output;
+
+  // The context has been validated before the problem is changed, and the
+  // fields are read from the typed view decoded when the context was 
+  // received by the Solver Manager.
+
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+  const Solver::ApplicationExecutionContext::View & TheView 
+                                                  = TheContext.GetView();
 
   // Setting the metric values one by one. In the setting of NebulOuS a metric
   // is either a numerical value or a string. Vectors are currently not
-  // supported as values.
+  // supported as values. The metric values are read directly from the shared
+  // snapshot if the context refers to a snapshot of the metric values.
+
+  if( MetricSnapshotStore::ReferencesSnapshot( TheView ) )
+  {
+    auto TheSnapshot = MetricSnapshotStore::Shared().Referenced( TheView );
 
-  for( const auto & [ TheName, MetricValue ] : 
-       Solver::MetricValueType( TheContext.at( 
-       Solver::ApplicationExecutionContext::Keys::ExecutionContext ) ) )
-    SetAMPLParameter( TheName, MetricValue );
+    for( const auto & [ TheName, MetricValue ] : TheSnapshot->MetricValues )
+      SetAMPLParameter( TheName, MetricValue );
+  }
+  else
+    for( const auto & [ TheName, MetricValue ] : 
+         TheView.Get< Keys::ExecutionContext >() )
+      SetAMPLParameter( TheName, MetricValue );
 
   // Setting the given objective as the active objective and all other
   // objective functions as 'dropped'. Note that this is experimental code
@@ -273,10 +798,8 @@ void AMPLSolver::SolveProblem(
 
   std::string OptimisationGoal;
 
-  if( TheContext.contains( 
-      Solver::ApplicationExecutionContext::Keys::ObjectiveFunctionLabel ) )
-    OptimisationGoal = TheContext.at( 
-      Solver::ApplicationExecutionContext::Keys::ObjectiveFunctionLabel );
+  if( TheView.Has< Keys::ObjectiveFunctionLabel >() )
+    OptimisationGoal = TheView.Get< Keys::ObjectiveFunctionLabel >();
   else if( !DefaultObjectiveFunction.empty() )
     OptimisationGoal = DefaultObjectiveFunction;
   else
@@ -328,9 +851,116 @@ void AMPLSolver::SolveProblem(
     throw std::invalid_argument( ErrorMessage.str() );
   }
 
-  // The problem is valid and can then be solved.
+  // The candidates of a context are evaluated without optimising the problem,
+  // and the evaluations are returned in a solution with empty objective and 
+  // variable values. Evaluations are never deployed.
 
-  Optimize();
+  if( TheView.Has< Keys::Candidates >() )
+  {
+    auto EvaluationStart = std::chrono::steady_clock::now();
+    JSON Evaluations = EvaluateCandidates( TheView.Get< Keys::Candidates >() );
+
+    Solver::Solution SolutionMessage( TheView.Get< Keys::TimeStamp >(),
+      OptimisationGoal, Solver::Solution::ObjectiveValuesType(), 
+      Solver::Solution::VariableValuesType(), false );
+
+    SolutionMessage[ Solver::Solution::Keys::SolveTime ] 
+      = std::chrono::duration_cast< std::chrono::microseconds >( 
+          std::chrono::steady_clock::now() - EvaluationStart ).count();
+    SolutionMessage[ Solver::Solution::Keys::CandidateEvaluations ] 
+      = Evaluations;
+
+    ReturnSolution( SolutionMessage, TheView, TheRequester );
+
+    Output << "Solver evaluated " << Evaluations.size() 
+           << " candidates for " << OptimisationGoal << std::endl;
+    return;
+  }
+
+  // The variable values of a warm start are set as the starting point for 
+  // the search instead of the values of the previous solution. Variables not
+  // in the model are ignored since the starting point may come from a 
+  // solution of an earlier version of the model. Back-end solvers accepting
+  // a start for integer variables will use a feasible starting point as the 
+  // initial incumbent.
+
+  if( TheView.Has< Keys::WarmStart >() )
+  {
+    const Solver::MetricValueType StartValues = TheView.Get< Keys::WarmStart >();
+
+    for( auto Variable : ProblemDefinition.getVariables() )
+      if( auto Start = StartValues.find( Variable.name() ); 
+          ( Start != StartValues.end() ) && Start->second.is_number() )
+        Variable.setValue( Start->second.get< double >() );
+  }
+
+  // The problem is solved by enumerating the configurations if the model
+  // has only integer variables with small domains, unless a neighbourhood 
+  // search is requested. The time used by the enumeration is reported as the
+  // solve time.
+
+  auto SolveStart = std::chrono::steady_clock::now();
+
+  bool Enumerated = !TheView.Has< Keys::Neighbourhood >() && 
+                    EnumerateProblem( OptimisationGoal );
+
+  // The variables are bounded by the bounds learned by the Solver Manager if
+  // the context has bounds for the variables of the model. The bounds are
+  // dropped by the guard if the solve throws, or if tightening the bounds 
+  // fails after some of the bounds have been imposed.
+
+  const Solver::MetricValueType TheBounds 
+        = TheView.Value< Keys::VariableBounds >( Solver::MetricValueType() );
+
+  bool Tightened = !Enumerated && !TheBounds.empty() && 
+                   !TheView.Has< Keys::Neighbourhood >();
+
+  ScopeGuard DropBounds( [&]( void ){ if( Tightened ) RelaxBounds(); } );
+
+  if( Tightened ) Tightened = TightenBounds( TheBounds );
+
+  // The problem is valid and can then be solved using the number of threads
+  // allocated to this solver by the Solver Manager. If the problem was solved
+  // with tightened bounds, it is solved again with the declared bounds if no
+  // feasible solution was found or if a variable is on a tightened bound, 
+  // since the optimum may then be outside of the tightened bounds. AMPL 
+  // reports solve result codes of 200 and above for infeasible, unbounded, 
+  // or failed solves. The time used by the solver is returned with the 
+  // solution, and includes both solves if the problem was solved again. The
+  // bounds are not tightened for a neighbourhood search since most of the 
+  // configuration variables are fixed.
+
+  SetThreadOption();
+
+  int TheResult = 0;
+
+  if( TheView.Has< Keys::Neighbourhood >() )
+    TheResult = NeighbourhoodSearch( OptimisationGoal, 
+                                     TheView.Get< Keys::Neighbourhood >() );
+  else if( !Enumerated )
+  {
+    Optimize();
+    TheResult = SolveResult();
+  }
+
+  if( Tightened )
+  {
+    bool Fallback = ( TheResult >= 200 ) || OnTightenedBound( TheBounds );
+
+    RelaxBounds();
+    Tightened = false;
+
+    if( Fallback )
+    {
+      Output << "AMPL Solver: The tightened bounds excluded the optimum and "
+             << "the problem is solved with the declared bounds" << std::endl;
+      Optimize();
+      TheResult = SolveResult();
+    }
+  }
+
+  auto SolveTime = std::chrono::duration_cast< std::chrono::microseconds >( 
+                   std::chrono::steady_clock::now() - SolveStart ).count();
 
   // Once the problem has been optimised, the objective values can be 
   // be obtained from the objectives
@@ -348,8 +978,7 @@ void AMPLSolver::SolveProblem(
   // application execution context has the deployment flag set.
 
   Solver::Solution::VariableValuesType VariableValues;
-  bool DeploymentFlagSet 
-       = TheContext.at( Solver::Solution::Keys::DeploymentFlag ).get<bool>();
+  bool DeploymentFlagSet = TheView.Value< Keys::DeploymentFlag >( false );
 
   for( auto Variable : ProblemDefinition.getVariables() )
   {
@@ -361,19 +990,122 @@ void AMPLSolver::SolveProblem(
   }
 
   // The found solution can then be returned to the requesting actor or topic
-  // and printed to the console for debugging purposes. This implies that 
-  // the message must be stored separately.
+  // and reported on the console. Only a summary is printed since formatting
+  // a large solution would delay the solver from taking the next context.
 
-  Solver::Solution SolutionMessage( 
-    TheContext.at( 
-      Solver::Solution::Keys::TimeStamp ).get< Solver::TimePointType >(),
+  Solver::Solution SolutionMessage( TheView.Get< Keys::TimeStamp >(),
     OptimisationGoal, ObjectiveValues, VariableValues, 
     DeploymentFlagSet );
 
-  Send( SolutionMessage, TheRequester ); 
+  SolutionMessage[ Solver::Solution::Keys::SolveTime   ] = SolveTime;
+  SolutionMessage[ Solver::Solution::Keys::SolveResult ] = TheResult;
+
+  ReturnSolution( SolutionMessage, TheView, TheRequester );
+
+  if( TheResult < 200 )
+    Output << "Solver found a solution for " << OptimisationGoal << " with " 
+           << VariableValues.size() << " variables and objective values " 
+           << JSON( ObjectiveValues ).dump() << std::endl;
+  else
+    Output << "Solver found no solution for " << OptimisationGoal 
+           << " with solve result " << TheResult << std::endl;
+}
+
+// The requester's correlation identifier, reply topic and batch flag are 
+// returned with the solution so that the Solver Manager can route the 
+// solution to the requester.
+
+void AMPLSolver::ReturnSolution( Solver::Solution & TheSolution, 
+  const ApplicationExecutionContext::View & TheView, const Address TheRequester )
+{
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+
+  TheSolution[ Solver::Solution::Keys::ModelVersion ] = ModelVersion;
+
+  if( TheView.Has< Keys::CorrelationID >() )
+    TheSolution[ Keys::CorrelationID ] = TheView.Get< Keys::CorrelationID >();
+
+  if( TheView.Has< Keys::ReplyTo >() )
+    TheSolution[ Keys::ReplyTo ] = TheView.Get< Keys::ReplyTo >();
+
+  if( TheView.Value< Keys::BatchSolution >( false ) )
+    TheSolution[ Keys::BatchSolution ] = true;
 
-  Output << "Solver found a solution:" << std::endl
-         << SolutionMessage.dump(2) << std::endl;
+  Send( TheSolution, TheRequester ); 
+}
+
+// -----------------------------------------------------------------------------
+// Candidate evaluation
+// -----------------------------------------------------------------------------
+//
+// The violated constraints of a candidate are found by one AMPL statement 
+// printing the index and the violation of every constraint violated by more 
+// than the tolerance, and the names of the constraints are read once for all
+// candidates.
+
+JSON AMPLSolver::EvaluateCandidates( 
+  const std::vector< Solver::MetricValueType > & TheCandidates )
+{
+  using Keys = Solver::Solution::Keys;
+
+  std::map< std::string, double > PreviousValues;
+
+  for( auto Variable : ProblemDefinition.getVariables() )
+    PreviousValues.emplace( Variable.name(), Variable.value() );
+
+  std::vector< std::string > ConstraintNames;
+  std::size_t NumberOfConstraints 
+    = ProblemDefinition.getValue( "_ncons" ).dbl();
+
+  for( std::size_t i = 1; i <= NumberOfConstraints; i++ )
+    ConstraintNames.push_back( ProblemDefinition.getValue( 
+      "_conname[" + std::to_string( i ) + "]" ).str() );
+
+  const std::string ViolationStatement = 
+    "printf {i in 1.._ncons: max(_con[i].lb - _con[i].body, "
+    "_con[i].body - _con[i].ub) > 1e-6}: \"%d %.17g\\n\", i, "
+    "max(_con[i].lb - _con[i].body, _con[i].body - _con[i].ub);";
+
+  JSON Evaluations = JSON::array();
+
+  for( const Solver::MetricValueType & TheCandidate : TheCandidates )
+  {
+    for( auto Variable : ProblemDefinition.getVariables() )
+      if( auto TheValue = TheCandidate.find( Variable.name() );
+          ( TheValue != TheCandidate.end() ) && TheValue->second.is_number() )
+        Variable.setValue( TheValue->second.get< double >() );
+      else
+        Variable.setValue( PreviousValues.at( Variable.name() ) );
+
+    Solver::Solution::ObjectiveValuesType ObjectiveValues;
+
+    for( auto TheObjective : ProblemDefinition.getObjectives() )
+      ObjectiveValues.emplace( TheObjective.name(), TheObjective.value() );
+
+    JSON Violations = JSON::object();
+
+    if( NumberOfConstraints > 0 )
+    {
+      std::istringstream Violated( 
+        ProblemDefinition.getOutput( ViolationStatement ) );
+      std::size_t Index;
+      double      Amount;
+
+      while( Violated >> Index >> Amount )
+        if( ( Index >= 1 ) && ( Index <= ConstraintNames.size() ) )
+          Violations[ ConstraintNames[ Index - 1 ] ] = Amount;
+    }
+
+    Evaluations.push_back( JSON{ 
+      { Keys::ObjectiveValues, ObjectiveValues }, 
+      { Keys::Violations,      Violations },
+      { Keys::Feasible,        Violations.empty() } } );
+  }
+
+  for( auto Variable : ProblemDefinition.getVariables() )
+    Variable.setValue( PreviousValues.at( Variable.name() ) );
+
+  return Evaluations;
 }
 
 // -----------------------------------------------------------------------------
@@ -393,36 +1125,54 @@ void AMPLSolver::SolveProblem(
 AMPLSolver::AMPLSolver( const std::string & TheActorName, 
                         const ampl::Environment & InstallationDirectory,
                         const std::filesystem::path & ProblemPath,
-                        const std::string TheSolverType )
+                        const std::string TheSolverType,
+                        std::size_t ConfigurationLimit )
 : Actor( TheActorName ),
   StandardFallbackHandler( Actor::GetAddress().AsString() ),
   NetworkingActor( Actor::GetAddress().AsString() ),
   Solver( Actor::GetAddress().AsString() ),
-  ProblemFileDirectory( ProblemPath ),
+  ProblemFileDirectory( ProblemPath ), SolverName( TheSolverType ),
+  BoundedVariables(), ChangeRates(), NeighbourhoodSize( 1 ),
+  MaxConfigurations( ConfigurationLimit ), IntegerVariables(),
   ProblemDefinition( InstallationDirectory ),
   ProblemUndefined( true ),
-  DefaultObjectiveFunction(), VariablesToConstants()
+  DefaultObjectiveFunction(), ModelVersion( 0 ), VariablesToConstants()
 {
   RegisterHandler( this, &AMPLSolver::DataFileUpdate );
 
   ProblemDefinition.setOption( "solver", TheSolverType );
 
-  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
-    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
-    DataFileMessage::AMQTopic
-  ), GetSessionLayerAddress() );
+  if( HasNetwork() )
+  {
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+      DataFileMessage::AMQTopic
+    ), GetSessionLayerAddress() );
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher,
+      Solver::ModelParameters::AMQTopic
+    ), GetSessionLayerAddress() );
+  }
 }
 
 // In case the network is still running when the actor is closing, the data file
-// subscription should be closed.
+// subscription and the model parameter publisher should be closed.
 
 AMPLSolver::~AMPLSolver()
 {
   if( HasNetwork() )
+  {
     Send( Theron::AMQ::NetworkLayer::TopicSubscription(
       Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
       DataFileMessage::AMQTopic
     ), GetSessionLayerAddress() );
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher,
+      Solver::ModelParameters::AMQTopic
+    ), GetSessionLayerAddress() );
+  }
 }
 
 } // namespace NebulOuS
@@ -34,6 +34,11 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <filesystem>                           // For problem files
 #include <source_location>                      // For better errors
 #include <map>                                  // Storing key-value pairs
+#include <unordered_set>                        // Bounded variable names
+#include <unordered_map>                        // Change rates
+#include <cstddef>                              // Neighbourhood sizes
+#include <vector>                               // Integer variable names
+#include <cstdint>                              // Model version digest
 
 // Other packages
 
@@ -105,6 +110,109 @@ private:
   void SetAMPLParameter( const std::string & ParameterName, 
                          const JSON & ParameterValue );
 
+  // --------------------------------------------------------------------------
+  // Thread budget
+  // --------------------------------------------------------------------------
+  //
+  // The back-end solver used by AMPL is given by name to the constructor and 
+  // it is stored since the option string for the solver is named after the 
+  // solver, e.g. "highs_options" for the HiGHS solver. 
+
+  const std::string SolverName;
+
+  // An option is passed to the back-end solver in the solver's option string
+  // under the name the option has for the solver. Any value of the option 
+  // already in the option string, set by the model file or by a previous 
+  // solve, will be replaced. The option string is not changed, and false is
+  // returned, if the option is not known for the solver.
+
+  bool SetSolverOption( 
+    const std::map< std::string, std::string > & OptionNames,
+    const std::string & TheValue );
+
+  // The thread budget received from the Solver Manager is passed to the 
+  // back-end solver as the thread option before each solve. Solvers that are
+  // not multi-threaded, like Couenne, or whose thread option is unknown will
+  // not have their options changed.
+
+  void SetThreadOption( void );
+
+  // --------------------------------------------------------------------------
+  // Tightened bounds
+  // --------------------------------------------------------------------------
+  //
+  // The Solver Manager may attach bounds learned from earlier solutions to
+  // the context. The bounds are imposed as range constraints on auxiliary 
+  // parameters declared for each bounded variable the first time the variable
+  // is bounded, and AMPL's presolve turns these range constraints into bounds
+  // of the variables before the problem is passed to the back-end solver. The
+  // names of the variables with declared bound constraints are remembered.
+
+  std::unordered_set< std::string > BoundedVariables;
+
+  // The bounds are set for the variables of the model and the constraints 
+  // restored by the first function, which returns true if any variable was
+  // bounded. The second function checks if a variable of the solution found
+  // is on one of the tightened bounds, and the third function drops all bound
+  // constraints so that the declared bounds apply for the next solve.
+
+  bool TightenBounds( const Solver::MetricValueType & TheBounds );
+  bool OnTightenedBound( const Solver::MetricValueType & TheBounds );
+  void RelaxBounds( void );
+
+  // --------------------------------------------------------------------------
+  // Neighbourhood search
+  // --------------------------------------------------------------------------
+  //
+  // A reconfiguration that must be found quickly can be searched for in the 
+  // neighbourhood of the deployed configuration. The configuration variables
+  // are the variables mapped to constants holding their deployed values, and
+  // all but a small subset of these variables are fixed to their deployed 
+  // values. The subset is optimised, and it is doubled if no better 
+  // configuration is found until all configuration variables are free or the
+  // time limit is reached. The time left is given as the time limit of the 
+  // back-end solver for each solve. If the time limit option of the solver
+  // is unknown, a warning is printed, the time limit is only checked between
+  // the solves, and at least one configuration variable is kept fixed so 
+  // that the search never becomes an unbounded solve of the full problem. 
+  // The fixings and the option string of the solver are restored when the 
+  // search ends, also if a solve fails. The search returns the solve result
+  // code of the best configuration found, or of the last solve if no 
+  // solution was found.
+  //
+  // The search adapts to the problem: The variables freed first are the ones
+  // that have most often changed in the improved configurations found, and 
+  // the size of the first subset is the size that last gave an improvement,
+  // halved if the improvement was found with the first subset.
+
+  std::unordered_map< std::string, double > ChangeRates;
+  std::size_t NeighbourhoodSize;
+
+  int NeighbourhoodSearch( const std::string & OptimisationGoal, 
+                           double TimeLimit );
+
+  // --------------------------------------------------------------------------
+  // Exhaustive enumeration
+  // --------------------------------------------------------------------------
+  //
+  // Models having only scalar integer variables with small domains are solved
+  // by evaluating all configurations with the Configuration Enumerator if the
+  // number of configurations is at most the given maximum. A maximum of zero
+  // disables the enumeration. The integer variables are found when the 
+  // problem is defined, and the list is empty if the model has variables that
+  // cannot be enumerated.
+
+  const std::size_t MaxConfigurations;
+  std::vector< std::string > IntegerVariables;
+
+  // The enumeration uses the current bounds of the variables and the problem
+  // expanded for the current parameter values. It returns false if the 
+  // problem must be solved by AMPL because the domains are too large, the 
+  // problem cannot be read from AMPL or compiled, or no configuration is 
+  // feasible. Otherwise the variables are set to the optimal configuration.
+
+  bool EnumerateProblem( const std::string & OptimisationGoal );
+
   // --------------------------------------------------------------------------
   // The optimisation problem
   // --------------------------------------------------------------------------
@@ -140,7 +248,10 @@ protected:
   //    value of the constant. 
   // Since these elements are parts of the optimisation problem message
   // whose class cannot be extended to contain these directly, it is 
-  // necessary to scope these keys differently for the compiler.
+  // necessary to scope these keys differently for the compiler. The keys 
+  // are public so that the problem message can be built by other actors.
+
+public:
 
   struct OptimisationProblem
   {
@@ -175,6 +286,12 @@ private:
 
   std::string DefaultObjectiveFunction;
 
+  // The model version is a digest of the model file content. It is returned 
+  // with the solutions so that solutions from different models can be told
+  // apart, also across restarts of the solver component.
+
+  std::uint64_t ModelVersion;
+
   // To set the constant values to the right variable values, the mapping 
   // between the variable name and the constant name must be stored in 
   // a map. 
@@ -194,7 +311,7 @@ private:
 public:
 
   class DataFileMessage
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -216,17 +333,17 @@ public:
 
     DataFileMessage( const std::string_view & TheDataFileName, 
                      const JSON & DataFileContent )
-    : JSONTopicMessage( AMQTopic, 
+    : TopicMessage( AMQTopic, 
       { { Keys::DataFile, TheDataFileName }, 
         { Keys::NewData, DataFileContent } } )
     {}
 
     DataFileMessage( const DataFileMessage & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other )
     {}
 
     DataFileMessage()
-    : JSONTopicMessage( AMQTopic )
+    : TopicMessage( AMQTopic )
     {}
 
     virtual ~DataFileMessage() = default;
@@ -258,6 +375,15 @@ protected:
   virtual void Optimize( void )
   { ProblemDefinition.solve(); }
 
+  // AMPL reports the outcome of the last solve as a result code, where codes
+  // of 200 and above are infeasible, unbounded, limited, or failed solves.
+
+  int SolveResult( void )
+  { 
+    return static_cast< int >( 
+      ProblemDefinition.getValue( "solve_result_num" ).dbl() ); 
+  }
+
   // The handler for the application execution context will first set all the
   // parameter values for the contex metrics to the received values, and then
   // optimise the problem. When a solution is found it will be sent back to 
@@ -267,6 +393,31 @@ protected:
   virtual void SolveProblem( const ApplicationExecutionContext & TheContext, 
                              const Address TheRequester ) override;
 
+  // The context is solved by a separate function, and the handler returns a
+  // failed solution with the reason if the problem is undefined or if the 
+  // solving throws, so that the requester always gets a reply and the 
+  // solver is returned to the pool of passive solvers.
+
+  void SolveContext( const ApplicationExecutionContext & TheContext, 
+                     const Address TheRequester );
+
+  // The solution is returned with the model version and the requester's 
+  // routing fields copied from the context.
+
+  void ReturnSolution( Solver::Solution & TheSolution, 
+                       const ApplicationExecutionContext::View & TheView,
+                       const Address TheRequester );
+
+  // A context may carry candidate configurations to be evaluated instead of
+  // optimised. Each candidate is evaluated by setting the variable values 
+  // and reading the objective values and the constraint violations, and the
+  // variables are restored to their previous values afterwards so that the 
+  // next solve starts from the previous solution. The evaluations are 
+  // returned as an array in the order of the candidates.
+
+  JSON EvaluateCandidates( 
+    const std::vector< Solver::MetricValueType > & TheCandidates );
+
   // --------------------------------------------------------------------------
   // Constructor and destructor
   // --------------------------------------------------------------------------
@@ -275,7 +426,9 @@ protected:
   // pointing to the AMPL installation directory. If this is given as empty,
   // then the path is taken from the corresponding environment variables. There
   // is also a path to the directory where the optimisation problem file will 
-  // be stored together with any required data files.
+  // be stored together with any required data files. The last argument is the
+  // largest number of configurations of an integer model that will be solved
+  // by enumeration instead of by AMPL, and zero disables the enumeration.
   //
   // Note that the constructors are declared as explicit because in theory 
   // a string could be converted to an Environment class or a Path and so to 
@@ -287,7 +440,8 @@ public:
   explicit AMPLSolver( const std::string & TheActorName, 
                        const ampl::Environment & InstallationDirectory,
                        const std::filesystem::path & ProblemPath,
-                       std::string  TheSolverType );
+                       std::string  TheSolverType,
+                       std::size_t  ConfigurationLimit = 0 );
 
   // If the path to the problem directory is omitted, it will be initialised to
   // a temporary directory.
@@ -0,0 +1,290 @@
+/*==============================================================================
+Batch Runner
+
+This file implements the Batch Runner actor solving a file of application
+execution contexts without an AMQ broker. Please see the header file for
+details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <iostream>                                // Standard streams
+#include <sstream>                                 // Reading files
+#include <stdexcept>                               // Standard exceptions
+#include <source_location>                         // Error locations
+
+#include "Utility/ConsolePrint.hpp"                // For logging
+
+#include "ExecutionControl.hpp"                    // Stopping the component
+#include "AMPLSolver.hpp"                          // Problem message keys
+#include "BatchRunner.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Problem definition
+// --------------------------------------------------------------------------
+//
+// The files are read in full as the content is sent as a string in the
+// problem definition message.
+
+std::string BatchRunner::ReadFile( const std::filesystem::path & TheFile )
+{
+  std::ifstream TheStream( TheFile );
+
+  if( !TheStream )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The batch input file " << TheFile
+                 << " could not be read";
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  std::ostringstream TheContent;
+  TheContent << TheStream.rdbuf();
+
+  return TheContent.str();
+}
+
+// The problem message has the same content as the message sent by the
+// Optimiser Controller, and it is sent to each solver in the pool.
+
+Solver::OptimisationProblem BatchRunner::ProblemMessage( 
+  const std::filesystem::path & ModelFile,
+  const std::filesystem::path & DataFile,
+  const std::string & ObjectiveFunction )
+{
+  using Keys = AMPLSolver::OptimisationProblem::Keys;
+
+  JSON TheProblem{
+    { Keys::ProblemFile,              ModelFile.filename().string() },
+    { Keys::ProblemDescription,       ReadFile( ModelFile )         },
+    { Keys::DefaultObjectiveFunction, ObjectiveFunction             } };
+
+  if( !DataFile.empty() )
+  {
+    TheProblem[ Keys::DataFile ]           = DataFile.filename().string();
+    TheProblem[ Keys::InitialisationData ] = ReadFile( DataFile );
+  }
+
+  return Solver::OptimisationProblem( TheProblem );
+}
+
+void BatchRunner::DefineProblem( const std::filesystem::path & ModelFile,
+                                 const std::filesystem::path & DataFile,
+                                 const std::string & ObjectiveFunction,
+                                 const std::string & SolverRootName,
+                                 unsigned int NumberOfSolvers )
+{
+  Solver::OptimisationProblem TheProblem( 
+    ProblemMessage( ModelFile, DataFile, ObjectiveFunction ) );
+
+  for( unsigned int i = 1; i <= NumberOfSolvers; i++ )
+    Send( TheProblem, Address( SolverRootName + "_" + std::to_string( i ) ) );
+}
+
+// --------------------------------------------------------------------------
+// Contexts
+// --------------------------------------------------------------------------
+//
+// The line number is counted for all lines, including empty lines, so that
+// it corresponds to the line of the input file.
+
+void BatchRunner::SubmitContexts( std::istream & Contexts )
+{
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+
+  std::string TheLine;
+  std::size_t LineNumber = 0;
+
+  while( std::getline( Contexts, TheLine ) )
+  {
+    LineNumber++;
+
+    if( TheLine.find_first_not_of( " \t\r" ) == std::string::npos )
+      continue;
+
+    Solver::ApplicationExecutionContext TheContext;
+
+    try
+    {
+      JSON & TheObject( TheContext );
+
+      TheObject = JSON::parse( TheLine );
+
+      if( !TheContext.contains( Keys::TimeStamp ) )
+        TheContext[ Keys::TimeStamp ] = LineNumber;
+
+      if( !TheContext.contains( Keys::CorrelationID ) )
+        TheContext[ Keys::CorrelationID ] = std::to_string( LineNumber );
+
+      TheContext[ Keys::ReplyTo ]
+        = std::string( Solver::ApplicationExecutionContext::LocalReply )
+        + GetAddress().AsString();
+
+      // A batch needs exactly one exact solution per context, and a context
+      // asking for an approximate solution would also get a predicted one.
+
+      TheContext.erase( Keys::Approximate );
+
+      // The context is validated by decoding its view, which is then passed
+      // on with the context to the Solver Manager.
+
+      TheContext.GetView();
+
+      SubmittedContexts++;
+      Send( TheContext, SolverManager );
+    }
+    catch( const std::exception & TheError )
+    {
+      Solver::Solution Failure( TheContext, TheError.what() );
+
+      if( !Failure.contains( Keys::CorrelationID ) )
+        Failure[ Keys::CorrelationID ] = std::to_string( LineNumber );
+
+      Theron::ConsoleOutput Output;
+      Output << "Batch Runner: The context on line " << LineNumber
+             << " is invalid: " << TheError.what() << std::endl;
+
+      SubmittedContexts++;
+      Send( Failure, GetAddress() );
+    }
+  }
+}
+
+// --------------------------------------------------------------------------
+// Solutions
+// --------------------------------------------------------------------------
+//
+// The reply address is internal and it is removed before the solution is
+// written. The failed solutions are written as error records and counted 
+// separately. The stop message is sent only once when the last solution has
+// been written and all contexts have been submitted.
+
+void BatchRunner::WriteSolution( const JSON & TheSolution )
+{
+  JSON TheRecord( TheSolution );
+  TheRecord.erase( Solver::Solution::Keys::ReplyTo );
+
+  if( TheRecord.contains( Solver::Solution::Keys::Error ) )
+    FailedContexts++;
+
+  Output << TheRecord.dump() << '\n';
+  WrittenSolutions++;
+}
+
+void BatchRunner::CheckCompletion( void )
+{
+  if( InputCompleted && ( WrittenSolutions >= SubmittedContexts ) &&
+      !BatchCompleted.exchange( true ) )
+  {
+    Output.flush();
+
+    Theron::ConsoleOutput Output;
+    Output << "Batch Runner: " << WrittenSolutions << " solutions written for "
+           << SubmittedContexts << " contexts of which " << FailedContexts
+           << " failed" << std::endl;
+
+    Send( ExecutionControl::StopMessage(), SolverManager );
+  }
+}
+
+void BatchRunner::ReturnSolution( const Solver::Solution & TheSolution,
+                                  const Address TheSolverManager )
+{
+  WriteSolution( TheSolution );
+  CheckCompletion();
+}
+
+void BatchRunner::ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                               const Address TheSolverManager )
+{
+  for( const JSON & TheSolution :
+       TheBatch.at( Solver::SolutionBatch::Keys::Solutions ) )
+    WriteSolution( TheSolution );
+
+  CheckCompletion();
+}
+
+// --------------------------------------------------------------------------
+// Constructor
+// --------------------------------------------------------------------------
+//
+// The handlers must be registered before the contexts are submitted since
+// the first solutions may be returned before the last context is read.
+
+BatchRunner::BatchRunner( const std::string & TheActorName,
+                          const Address & TheSolverManager,
+                          const std::string & SolverRootName,
+                          unsigned int NumberOfSolvers,
+                          const std::filesystem::path & ModelFile,
+                          const std::filesystem::path & DataFile,
+                          const std::string & ObjectiveFunction,
+                          const std::filesystem::path & ContextFile,
+                          const std::filesystem::path & SolutionFile )
+: Actor( TheActorName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() ),
+  SolverManager( TheSolverManager ),
+  Output(),
+  SubmittedContexts( 0 ), WrittenSolutions( 0 ), FailedContexts( 0 ),
+  InputCompleted( false ), BatchCompleted( false )
+{
+  if( SolutionFile.empty() || ( SolutionFile == "-" ) )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "An output file must be given for the solutions in batch "
+                 << "mode since the standard output has the log messages";
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+
+  Output.open( SolutionFile );
+
+  if( !Output )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The batch output file " << SolutionFile
+                 << " could not be created";
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  RegisterHandler( this, &BatchRunner::ReturnSolution );
+  RegisterHandler( this, &BatchRunner::ReturnBatch    );
+
+  DefineProblem( ModelFile, DataFile, ObjectiveFunction, SolverRootName,
+                 NumberOfSolvers );
+
+  if( ContextFile == "-" )
+    SubmitContexts( std::cin );
+  else
+  {
+    std::istringstream Contexts( ReadFile( ContextFile ) );
+    SubmitContexts( Contexts );
+  }
+
+  InputCompleted = true;
+  CheckCompletion();
+}
+
+} // End name space NebulOuS
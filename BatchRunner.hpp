@@ -0,0 +1,175 @@
+/*==============================================================================
+Batch Runner
+
+Capacity planning studies and performance tests need to solve a large set of
+application execution contexts for a given model, and the results should be
+reproducible without a running AMQ broker and the other NebulOuS components.
+The Batch Runner is used when the Solver Component is started in batch mode.
+It loads the model file and the optional data file from disk and defines the
+optimisation problem for all the solvers of the local Solver Manager's pool.
+It then reads the application execution contexts from a file, or from the
+standard input, with one JSON context message per line, and sends them to the
+Solver Manager. The solutions are returned by the Solver Manager to the Batch
+Runner as local replies, and they are written with one JSON solution message
+per line to the output file, or to the standard output.
+
+A context without a time stamp is given its line number as time stamp so that
+the contexts are solved in the order of the input, and a context without a
+correlation identifier is given its line number as correlation identifier so
+that the solutions, which are written in the order they are found, can be
+matched with the contexts. A line that is not a valid context, or a context
+that could not be solved, is answered by an error record with the reason under
+the key "Error" and the correlation identifier of the line, so that there is
+one output line for every context. When all contexts have been answered, the
+Batch Runner sends the stop message to the Solver Manager to terminate the
+Solver Component.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_BATCH_RUNNER
+#define NEBULOUS_BATCH_RUNNER
+
+// Standard headers
+
+#include <string>                               // Standard strings
+#include <filesystem>                           // File paths
+#include <fstream>                              // Output file
+#include <cstddef>                              // Counters
+#include <atomic>                               // Shared counters
+#include <istream>                              // Context input
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// Theron++ headers
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+
+// NebulOuS headers
+
+#include "Solver.hpp"                           // Context and solution messages
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Batch Runner
+
+==============================================================================*/
+
+class BatchRunner
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler
+{
+  // --------------------------------------------------------------------------
+  // Output
+  // --------------------------------------------------------------------------
+  //
+  // The solutions are written to the output file. The standard output cannot
+  // be used since the solvers, and AMPL, write their log messages there, and
+  // the solution lines would be mixed with text that is not JSON.
+
+private:
+
+  const Address SolverManager;
+  std::ofstream Output;
+
+  // The number of contexts submitted and the number of solutions written are
+  // counted to know when the batch is completed. The contexts are submitted
+  // by the constructor while the solutions may already be returned to the 
+  // actor's handlers, and the counters are therefore atomic. The batch is 
+  // only completed when all contexts have been submitted.
+
+  std::atomic< std::size_t > SubmittedContexts, WrittenSolutions, 
+                             FailedContexts;
+  std::atomic< bool >        InputCompleted, BatchCompleted;
+
+  // --------------------------------------------------------------------------
+  // Problem definition and contexts
+  // --------------------------------------------------------------------------
+  //
+  // The problem is defined by sending the optimisation problem message to
+  // each solver of the pool. The solvers are addressed by the root name of
+  // the solvers and their sequence numbers as given by the Solver Manager.
+  // A runtime error is thrown if a file cannot be read. The problem message
+  // is public since it is also used by the Training Set Generator.
+
+public:
+
+  static std::string ReadFile( const std::filesystem::path & TheFile );
+
+  static Solver::OptimisationProblem ProblemMessage( 
+    const std::filesystem::path & ModelFile,
+    const std::filesystem::path & DataFile,
+    const std::string & ObjectiveFunction );
+
+private:
+
+  void DefineProblem( const std::filesystem::path & ModelFile,
+                      const std::filesystem::path & DataFile,
+                      const std::string & ObjectiveFunction,
+                      const std::string & SolverRootName,
+                      unsigned int NumberOfSolvers );
+
+  // The contexts are read line by line and submitted to the Solver Manager.
+  // Invalid lines are reported on the console and answered by a failed 
+  // solution sent to this actor so that the error record is written by the
+  // same handler as the solutions.
+
+  void SubmitContexts( std::istream & Contexts );
+
+  // --------------------------------------------------------------------------
+  // Solutions
+  // --------------------------------------------------------------------------
+  //
+  // Each solution is written on one line, and batches of solutions are split
+  // into their solutions. The Solver Manager is stopped when the last
+  // solution has been written.
+
+  void WriteSolution( const JSON & TheSolution );
+  void CheckCompletion( void );
+
+  void ReturnSolution( const Solver::Solution & TheSolution,
+                       const Address TheSolverManager );
+
+  void ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                    const Address TheSolverManager );
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The constructor takes the name of the actor, the address of the Solver
+  // Manager, the root name and the number of the solvers in the pool, the
+  // model file, the optional data file, and the default objective function
+  // of the model. The contexts are read from the given file, or from the
+  // standard input if the file name is "-", and the solutions are written to
+  // the given output file. An invalid argument exception is thrown if no
+  // output file is given. The problem is defined and all contexts are 
+  // submitted by the constructor.
+
+public:
+
+  BatchRunner( const std::string & TheActorName,
+               const Address & TheSolverManager,
+               const std::string & SolverRootName,
+               unsigned int NumberOfSolvers,
+               const std::filesystem::path & ModelFile,
+               const std::filesystem::path & DataFile,
+               const std::string & ObjectiveFunction,
+               const std::filesystem::path & ContextFile,
+               const std::filesystem::path & SolutionFile );
+
+  BatchRunner( const BatchRunner & Other ) = delete;
+
+  virtual ~BatchRunner() = default;
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_BATCH_RUNNER
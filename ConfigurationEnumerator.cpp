@@ -0,0 +1,602 @@
+/*==============================================================================
+Configuration Enumerator
+
+This file implements the compilation of the expanded AMPL problem and the
+parallel evaluation of all configurations of the variables.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <unordered_map>          // Variables and functions by name
+#include <stdexcept>              // Parse errors
+#include <cctype>                 // Character classes
+#include <cmath>                  // Functions
+#include <algorithm>              // Minimum and maximum
+#include <thread>                 // Parallel search
+
+#include "ConfigurationEnumerator.hpp"
+
+namespace NebulOuS
+{
+// -----------------------------------------------------------------------------
+// Parser
+// -----------------------------------------------------------------------------
+//
+// The text of the body of a statement is split into numbers, names, and
+// operators. Any other character, like the quotes of indexed names, makes the
+// statement invalid. Parse errors are thrown as invalid arguments and caught
+// by the compile function.
+
+class ConfigurationEnumerator::Parser
+{
+private:
+
+  std::vector< std::string > Tokens;
+  std::size_t                Next;
+
+  const std::unordered_map< std::string, std::size_t > & VariableIndex;
+
+  const std::string & Peek( void ) const
+  {
+    static const std::string End;
+    return Next < Tokens.size() ? Tokens[ Next ] : End;
+  }
+
+  bool Accept( const std::string & TheToken )
+  {
+    if( Peek() != TheToken ) return false;
+
+    Next++;
+    return true;
+  }
+
+  void Expect( const std::string & TheToken )
+  {
+    if( !Accept( TheToken ) )
+      throw std::invalid_argument( "Expected " + TheToken + " before " + Peek() );
+  }
+
+  // The grammar is the usual precedence of the arithmetic operators with the
+  // power operator binding tighter than the unary minus, as in AMPL.
+
+  void Primary( Program & TheProgram );
+  void Power  ( Program & TheProgram );
+  void Unary  ( Program & TheProgram );
+  void Term   ( Program & TheProgram );
+
+public:
+
+  void Expression( Program & TheProgram );
+
+  // Relations are returned in the order they appear in the statement so that
+  // a range constraint gives two relations.
+
+  std::optional< Relation > NextRelation( void )
+  {
+    if( Accept( "<=" ) || Accept( "<" ) ) return Relation::LessEqual;
+    if( Accept( ">=" ) || Accept( ">" ) ) return Relation::GreaterEqual;
+    if( Accept( "==" ) || Accept( "=" ) ) return Relation::Equal;
+    return std::nullopt;
+  }
+
+  bool AtEnd( void ) const
+  { return Next >= Tokens.size(); }
+
+  Parser( std::string_view TheText,
+          const std::unordered_map< std::string, std::size_t > & Names );
+};
+
+ConfigurationEnumerator::Parser::Parser( std::string_view TheText,
+  const std::unordered_map< std::string, std::size_t > & Names )
+: Tokens(), Next( 0 ), VariableIndex( Names )
+{
+  std::size_t Position = 0;
+
+  while( Position < TheText.size() )
+  {
+    unsigned char Character = TheText[ Position ];
+    std::size_t   Start     = Position;
+
+    if( std::isspace( Character ) )
+    {
+      Position++;
+      continue;
+    }
+    else if( std::isdigit( Character ) || ( Character == '.' ) )
+    {
+      while( ( Position < TheText.size() ) &&
+             ( std::isdigit( static_cast< unsigned char >( TheText[ Position ] ) )
+               || ( TheText[ Position ] == '.' ) ) )
+        Position++;
+
+      if( ( Position < TheText.size() ) &&
+          ( ( TheText[ Position ] == 'e' ) || ( TheText[ Position ] == 'E' ) ) )
+      {
+        Position++;
+
+        if( ( Position < TheText.size() ) &&
+            ( ( TheText[ Position ] == '+' ) || ( TheText[ Position ] == '-' ) ) )
+          Position++;
+
+        while( ( Position < TheText.size() ) &&
+               std::isdigit( static_cast< unsigned char >( TheText[ Position ] ) ) )
+          Position++;
+      }
+    }
+    else if( std::isalpha( Character ) || ( Character == '_' ) )
+      while( ( Position < TheText.size() ) &&
+             ( std::isalnum( static_cast< unsigned char >( TheText[ Position ] ) )
+               || ( TheText[ Position ] == '_' ) ) )
+        Position++;
+    else if( TheText.substr( Position, 2 ) == "<=" ||
+             TheText.substr( Position, 2 ) == ">=" ||
+             TheText.substr( Position, 2 ) == "==" ||
+             TheText.substr( Position, 2 ) == "**" )
+      Position += 2;
+    else if( std::string_view( "+-*/^(),<>=" ).find( Character )
+             != std::string_view::npos )
+      Position++;
+    else
+      throw std::invalid_argument( "Unsupported character in expression" );
+
+    Tokens.emplace_back( TheText.substr( Start, Position - Start ) );
+  }
+}
+
+// A name followed by a parenthesis is a function, and any other name must be
+// a variable since the parameters have been replaced by their values.
+
+void ConfigurationEnumerator::Parser::Primary( Program & TheProgram )
+{
+  static const std::unordered_map< std::string, Operation > Functions{
+    { "sqrt", Operation::Sqrt }, { "exp", Operation::Exp },
+    { "log", Operation::Log }, { "log10", Operation::Log10 },
+    { "abs", Operation::Abs }, { "sin", Operation::Sin },
+    { "cos", Operation::Cos }, { "tan", Operation::Tan },
+    { "floor", Operation::Floor }, { "ceil", Operation::Ceil },
+    { "min", Operation::Min }, { "max", Operation::Max }
+  };
+
+  std::string TheToken = Peek();
+
+  if( TheToken.empty() )
+    throw std::invalid_argument( "Unexpected end of expression" );
+
+  Next++;
+
+  if( TheToken == "(" )
+  {
+    Expression( TheProgram );
+    Expect( ")" );
+  }
+  else if( std::isdigit( static_cast< unsigned char >( TheToken.front() ) ) ||
+           ( TheToken.front() == '.' ) )
+    TheProgram.push_back( Instruction{ Operation::Constant,
+                                       std::stod( TheToken ), 0 } );
+  else if( Accept( "(" ) )
+  {
+    auto TheFunction = Functions.find( TheToken );
+
+    if( TheFunction == Functions.end() )
+      throw std::invalid_argument( "Unsupported function " + TheToken );
+
+    Expression( TheProgram );
+
+    if( ( TheFunction->second == Operation::Min ) ||
+        ( TheFunction->second == Operation::Max ) )
+      while( Accept( "," ) )
+      {
+        Expression( TheProgram );
+        TheProgram.push_back( Instruction{ TheFunction->second, 0.0, 0 } );
+      }
+    else
+      TheProgram.push_back( Instruction{ TheFunction->second, 0.0, 0 } );
+
+    Expect( ")" );
+  }
+  else if( auto TheVariable = VariableIndex.find( TheToken );
+           TheVariable != VariableIndex.end() )
+    TheProgram.push_back( Instruction{ Operation::Variable, 0.0,
+                                       TheVariable->second } );
+  else
+    throw std::invalid_argument( "Unknown name " + TheToken );
+}
+
+void ConfigurationEnumerator::Parser::Power( Program & TheProgram )
+{
+  Primary( TheProgram );
+
+  if( Accept( "^" ) || Accept( "**" ) )
+  {
+    Unary( TheProgram );
+    TheProgram.push_back( Instruction{ Operation::Power, 0.0, 0 } );
+  }
+}
+
+void ConfigurationEnumerator::Parser::Unary( Program & TheProgram )
+{
+  if( Accept( "-" ) )
+  {
+    Unary( TheProgram );
+    TheProgram.push_back( Instruction{ Operation::Negate, 0.0, 0 } );
+  }
+  else
+  {
+    Accept( "+" );
+    Power( TheProgram );
+  }
+}
+
+void ConfigurationEnumerator::Parser::Term( Program & TheProgram )
+{
+  Unary( TheProgram );
+
+  while( true )
+    if( Accept( "*" ) )
+    {
+      Unary( TheProgram );
+      TheProgram.push_back( Instruction{ Operation::Multiply, 0.0, 0 } );
+    }
+    else if( Accept( "/" ) )
+    {
+      Unary( TheProgram );
+      TheProgram.push_back( Instruction{ Operation::Divide, 0.0, 0 } );
+    }
+    else break;
+}
+
+void ConfigurationEnumerator::Parser::Expression( Program & TheProgram )
+{
+  Term( TheProgram );
+
+  while( true )
+    if( Accept( "+" ) )
+    {
+      Term( TheProgram );
+      TheProgram.push_back( Instruction{ Operation::Add, 0.0, 0 } );
+    }
+    else if( Accept( "-" ) )
+    {
+      Term( TheProgram );
+      TheProgram.push_back( Instruction{ Operation::Subtract, 0.0, 0 } );
+    }
+    else break;
+}
+
+// -----------------------------------------------------------------------------
+// Compiling the problem
+// -----------------------------------------------------------------------------
+//
+// The expanded text is a sequence of statements ended by semicolons, where
+// each statement has a header with the kind and the name of the objective
+// or the constraint followed by a colon and the expression. Objectives other
+// than the given objective function are ignored. The difference program of a
+// relation is the left program followed by the right program and a
+// subtraction.
+
+bool ConfigurationEnumerator::Compile( std::string_view ExpandedProblem,
+                                       const std::string & ObjectiveFunction )
+{
+  std::unordered_map< std::string, std::size_t > VariableIndex;
+
+  for( std::size_t i = 0; i < Variables.size(); i++ )
+    VariableIndex.emplace( Variables[ i ].Name, i );
+
+  Objective.clear();
+  Constraints.clear();
+
+  try
+  {
+    std::size_t Start = 0, End;
+
+    while( ( End = ExpandedProblem.find( ';', Start ) ) != std::string_view::npos )
+    {
+      std::string_view Statement = ExpandedProblem.substr( Start, End - Start );
+      std::size_t      Colon     = Statement.find( ':' );
+      Start = End + 1;
+
+      if( Colon == std::string_view::npos )
+        throw std::invalid_argument( "Statement without header" );
+
+      Parser Body( Statement.substr( Colon + 1 ), VariableIndex );
+
+      std::string_view TheHeader = Statement.substr( 0, Colon );
+      TheHeader.remove_prefix( std::min( TheHeader.find_first_not_of( " \t\r\n" ),
+                                         TheHeader.size() ) );
+
+      if( TheHeader.starts_with( "minimize" ) ||
+          TheHeader.starts_with( "maximize" ) )
+      {
+        std::string_view TheName = TheHeader.substr( 8 );
+        TheName.remove_prefix( std::min( TheName.find_first_not_of( " \t" ),
+                                         TheName.size() ) );
+        TheName = TheName.substr( 0, TheName.find_last_not_of( " \t\r\n" ) + 1 );
+
+        if( TheName != ObjectiveFunction ) continue;
+
+        Minimise = TheHeader.starts_with( "minimize" );
+        Body.Expression( Objective );
+      }
+      else if( TheHeader.starts_with( "subject to" ) )
+      {
+        Program Left;
+        Body.Expression( Left );
+
+        while( auto TheRelation = Body.NextRelation() )
+        {
+          Program Right;
+          Body.Expression( Right );
+
+          Constraint TheConstraint{ Left, *TheRelation };
+          TheConstraint.Difference.insert( TheConstraint.Difference.end(),
+                                           Right.begin(), Right.end() );
+          TheConstraint.Difference.push_back(
+            Instruction{ Operation::Subtract, 0.0, 0 } );
+
+          Constraints.push_back( TheConstraint );
+          Left = Right;
+        }
+      }
+      else
+        throw std::invalid_argument( "Unsupported statement" );
+
+      if( !Body.AtEnd() )
+        throw std::invalid_argument( "Unexpected text after expression" );
+    }
+  }
+  catch( const std::exception & )
+  {
+    Objective.clear();
+    Constraints.clear();
+    return false;
+  }
+
+  return !Objective.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Evaluation
+// -----------------------------------------------------------------------------
+//
+// The program is evaluated for all lanes with one loop over the lanes per
+// instruction. The stack is allocated by the caller to avoid allocations in
+// the inner loop.
+
+void ConfigurationEnumerator::Evaluate( const Program & TheProgram,
+                                        const std::vector< Lane > & Values,
+                                        std::vector< Lane > & Stack,
+                                        Lane & Result )
+{
+  std::size_t Top = 0;
+
+  for( const auto & TheInstruction : TheProgram )
+  {
+    auto & A = Stack[ Top - ( Top > 0 ? 1 : 0 ) ];
+    auto & B = Stack[ Top > 1 ? Top - 2 : 0 ];
+
+    switch( TheInstruction.Code )
+    {
+      case Operation::Constant:
+        Stack[ Top ].fill( TheInstruction.Constant );
+        Top++;
+        break;
+      case Operation::Variable:
+        Stack[ Top ] = Values[ TheInstruction.Variable ];
+        Top++;
+        break;
+      case Operation::Add:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = B[i] + A[i];
+        Top--;
+        break;
+      case Operation::Subtract:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = B[i] - A[i];
+        Top--;
+        break;
+      case Operation::Multiply:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = B[i] * A[i];
+        Top--;
+        break;
+      case Operation::Divide:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = B[i] / A[i];
+        Top--;
+        break;
+      case Operation::Power:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = std::pow( B[i], A[i] );
+        Top--;
+        break;
+      case Operation::Min:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = std::min( B[i], A[i] );
+        Top--;
+        break;
+      case Operation::Max:
+        for( std::size_t i = 0; i < Lanes; i++ ) B[i] = std::max( B[i], A[i] );
+        Top--;
+        break;
+      case Operation::Negate:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = -A[i];
+        break;
+      case Operation::Sqrt:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::sqrt( A[i] );
+        break;
+      case Operation::Exp:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::exp( A[i] );
+        break;
+      case Operation::Log:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::log( A[i] );
+        break;
+      case Operation::Log10:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::log10( A[i] );
+        break;
+      case Operation::Abs:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::fabs( A[i] );
+        break;
+      case Operation::Sin:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::sin( A[i] );
+        break;
+      case Operation::Cos:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::cos( A[i] );
+        break;
+      case Operation::Tan:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::tan( A[i] );
+        break;
+      case Operation::Floor:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::floor( A[i] );
+        break;
+      case Operation::Ceil:
+        for( std::size_t i = 0; i < Lanes; i++ ) A[i] = std::ceil( A[i] );
+        break;
+    }
+  }
+
+  Result = Stack[ 0 ];
+}
+
+// The configurations of a range are generated by counting in mixed radix,
+// and the lanes past the end of the range are marked infeasible. Comparisons
+// with values that are not numbers are false, so configurations where an
+// expression is undefined are never selected.
+
+std::optional< ConfigurationEnumerator::Candidate >
+ConfigurationEnumerator::Search( std::size_t First, std::size_t Last ) const
+{
+  constexpr double Tolerance = 1e-6;
+
+  std::size_t StackSize = Objective.size();
+
+  for( const Constraint & TheConstraint : Constraints )
+    StackSize = std::max( StackSize, TheConstraint.Difference.size() );
+
+  std::vector< Lane > Values( Variables.size() ), Stack( StackSize + 1 );
+  Lane Result, ObjectiveValues;
+  std::array< bool,   Lanes > Feasible;
+
+  std::vector< long > Counter( Variables.size() );
+  std::size_t Remainder = First;
+
+  for( std::size_t v = 0; v < Variables.size(); v++ )
+  {
+    std::size_t Size = Variables[ v ].Upper - Variables[ v ].Lower + 1;
+    Counter[ v ] = Variables[ v ].Lower + static_cast< long >( Remainder % Size );
+    Remainder /= Size;
+  }
+
+  std::optional< Candidate > Best;
+
+  for( std::size_t Batch = First; Batch < Last; Batch += Lanes )
+  {
+    std::size_t Active = std::min( Lanes, Last - Batch );
+
+    for( std::size_t Lane = 0; Lane < Lanes; Lane++ )
+    {
+      for( std::size_t v = 0; v < Variables.size(); v++ )
+        Values[ v ][ Lane ] = static_cast< double >( Counter[ v ] );
+
+      Feasible[ Lane ] = Lane < Active;
+
+      if( Lane < Active )
+        for( std::size_t v = 0; v < Variables.size(); v++ )
+        {
+          if( ++Counter[ v ] <= Variables[ v ].Upper ) break;
+          Counter[ v ] = Variables[ v ].Lower;
+        }
+    }
+
+    for( const Constraint & TheConstraint : Constraints )
+    {
+      Evaluate( TheConstraint.Difference, Values, Stack, Result );
+
+      switch( TheConstraint.Sense )
+      {
+        case Relation::LessEqual:
+          for( std::size_t i = 0; i < Lanes; i++ )
+            Feasible[i] = Feasible[i] && ( Result[i] <= Tolerance );
+          break;
+        case Relation::GreaterEqual:
+          for( std::size_t i = 0; i < Lanes; i++ )
+            Feasible[i] = Feasible[i] && ( Result[i] >= -Tolerance );
+          break;
+        case Relation::Equal:
+          for( std::size_t i = 0; i < Lanes; i++ )
+            Feasible[i] = Feasible[i] && ( std::fabs( Result[i] ) <= Tolerance );
+          break;
+      }
+    }
+
+    Evaluate( Objective, Values, Stack, ObjectiveValues );
+
+    for( std::size_t Lane = 0; Lane < Active; Lane++ )
+      if( Feasible[ Lane ] && !std::isnan( ObjectiveValues[ Lane ] ) &&
+          ( !Best || ( Minimise ? ObjectiveValues[ Lane ] < Best->Value
+                                : ObjectiveValues[ Lane ] > Best->Value ) ) )
+        Best = Candidate{ ObjectiveValues[ Lane ], Batch + Lane };
+  }
+
+  return Best;
+}
+
+// -----------------------------------------------------------------------------
+// Optimum
+// -----------------------------------------------------------------------------
+//
+// The configurations are split in equal ranges over the threads, and ties
+// between the threads are resolved in favour of the lowest configuration
+// number so that the result does not depend on the number of threads.
+
+std::size_t ConfigurationEnumerator::Configurations( void ) const
+{
+  std::size_t Count = 1;
+
+  for( const Domain & TheDomain : Variables )
+    Count *= static_cast< std::size_t >( TheDomain.Upper - TheDomain.Lower + 1 );
+
+  return Count;
+}
+
+std::optional< std::vector< long > >
+ConfigurationEnumerator::Optimum( unsigned int Threads ) const
+{
+  std::size_t Count  = Configurations(),
+              Blocks = std::clamp< std::size_t >( ( Count + Lanes - 1 ) / Lanes,
+                                                  1, std::max( Threads, 1u ) ),
+              Step   = ( Count + Blocks - 1 ) / Blocks;
+
+  std::vector< std::optional< Candidate > > Results( Blocks );
+
+  {
+    std::vector< std::jthread > Workers;
+
+    for( std::size_t Block = 1; Block < Blocks; Block++ )
+      Workers.emplace_back( [ this, &Results, Block, Step, Count ](){
+        Results[ Block ] = Search( std::min( Block * Step, Count ),
+                                   std::min( ( Block + 1 ) * Step, Count ) );
+      });
+
+    Results[ 0 ] = Search( 0, std::min( Step, Count ) );
+  }
+
+  std::optional< Candidate > Best;
+
+  for( const auto & TheResult : Results )
+    if( TheResult &&
+        ( !Best || ( Minimise ? TheResult->Value < Best->Value
+                              : TheResult->Value > Best->Value ) ) )
+      Best = TheResult;
+
+  if( !Best ) return std::nullopt;
+
+  std::vector< long > TheValues( Variables.size() );
+  std::size_t Remainder = Best->Configuration;
+
+  for( std::size_t v = 0; v < Variables.size(); v++ )
+  {
+    std::size_t Size = Variables[ v ].Upper - Variables[ v ].Lower + 1;
+    TheValues[ v ] = Variables[ v ].Lower + static_cast< long >( Remainder % Size );
+    Remainder /= Size;
+  }
+
+  return TheValues;
+}
+
+}      // namespace NebulOuS
@@ -0,0 +1,169 @@
+/*==============================================================================
+Configuration Enumerator
+
+Many applications have only a few integer decision variables with small
+domains, like the number of replicas and the number of cores of a few
+components. The optimal configuration of such problems can be found faster by
+evaluating the objective function and the constraints for every configuration
+than by passing the problem to a general solver like Couenne. The Configuration
+Enumerator compiles the objective function and the constraints from the text
+produced by the AMPL 'expand' command, where all parameters have been replaced
+by their current values, into small programs that are evaluated for all
+configurations of the variables.
+
+The programs are evaluated for a batch of configurations at the time, with one
+lane per configuration, so that each instruction is a loop over the lanes that
+the compiler can vectorise. The configurations are split into blocks that are
+evaluated in parallel by the given number of threads.
+
+The compiler accepts the arithmetic operators, powers, and the common
+functions of one or two arguments. The problem is rejected if the expanded
+text contains anything else, like conditional expressions, indexed variables,
+or defined variables, and the problem should then be solved by AMPL.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_CONFIGURATION_ENUMERATOR
+#define NEBULOUS_CONFIGURATION_ENUMERATOR
+
+// Standard headers
+
+#include <string>                               // Normal strings
+#include <string_view>                          // Expanded problem text
+#include <vector>                               // Programs and domains
+#include <array>                                // Lanes of values
+#include <optional>                             // Infeasible problems
+#include <cstddef>                              // Sizes
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Configuration Enumerator
+
+==============================================================================*/
+
+class ConfigurationEnumerator
+{
+  // --------------------------------------------------------------------------
+  // Programs
+  // --------------------------------------------------------------------------
+  //
+  // An expression is compiled to a program in postfix order where each
+  // instruction pushes a constant or a variable value on the stack, or
+  // replaces the top elements of the stack with the result of an operation.
+
+private:
+
+  enum class Operation
+  {
+    Constant, Variable, Add, Subtract, Multiply, Divide, Power, Negate,
+    Sqrt, Exp, Log, Log10, Abs, Sin, Cos, Tan, Floor, Ceil, Min, Max
+  };
+
+  struct Instruction
+  {
+    Operation   Code;
+    double      Constant;
+    std::size_t Variable;
+  };
+
+  using Program = std::vector< Instruction >;
+
+  // A constraint is kept as the program for the difference between its left
+  // and right hand sides and the relation between the sides.
+
+  enum class Relation { LessEqual, GreaterEqual, Equal };
+
+  struct Constraint
+  {
+    Program  Difference;
+    Relation Sense;
+  };
+
+  // --------------------------------------------------------------------------
+  // The problem
+  // --------------------------------------------------------------------------
+  //
+  // The variables are given with their integral bounds, and the position of
+  // a variable in this list is the index used by the programs.
+
+public:
+
+  struct Domain
+  {
+    std::string Name;
+    long        Lower, Upper;
+  };
+
+private:
+
+  const std::vector< Domain > Variables;
+
+  Program                   Objective;
+  bool                      Minimise;
+  std::vector< Constraint > Constraints;
+
+  // The compiler is a recursive descent parser over the tokens of a
+  // statement, and it is defined in the implementation file.
+
+  class Parser;
+
+  // The configurations are numbered in mixed radix with the first variable
+  // changing fastest, and each thread searches a range of configurations
+  // returning the value and the number of the best feasible configuration.
+
+  static constexpr std::size_t Lanes = 64;
+  using Lane = std::array< double, Lanes >;
+
+  // A program is evaluated for all lanes with one loop over the lanes per
+  // instruction, using a stack allocated by the caller.
+
+  static void Evaluate( const Program & TheProgram,
+                        const std::vector< Lane > & Values,
+                        std::vector< Lane > & Stack, Lane & Result );
+
+  struct Candidate
+  {
+    double      Value;
+    std::size_t Configuration;
+  };
+
+  std::optional< Candidate > Search( std::size_t First, std::size_t Last ) const;
+
+  // --------------------------------------------------------------------------
+  // Interface
+  // --------------------------------------------------------------------------
+  //
+  // The expanded problem text is compiled for the named objective function,
+  // and false is returned if the text contains an expression that cannot be
+  // compiled or if the objective function is missing.
+
+public:
+
+  bool Compile( std::string_view ExpandedProblem,
+                const std::string & ObjectiveFunction );
+
+  // The optimal configuration is returned as the values of the variables in
+  // the order of the domains, or no value if no configuration is feasible.
+
+  std::optional< std::vector< long > > Optimum( unsigned int Threads ) const;
+
+  // The number of configurations to evaluate is the product of the sizes of
+  // the domains.
+
+  std::size_t Configurations( void ) const;
+
+  ConfigurationEnumerator( const std::vector< Domain > & TheVariables )
+  : Variables( TheVariables ), Objective(), Minimise( true ), Constraints()
+  {}
+
+  ConfigurationEnumerator( const ConfigurationEnumerator & Other ) = delete;
+  ~ConfigurationEnumerator() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_CONFIGURATION_ENUMERATOR
@@ -0,0 +1,314 @@
+/*==============================================================================
+Context Sampler
+
+This file implements the Sobol sequence and the Latin hypercube sampling of
+the application execution contexts. Please see the header file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <array>                                   // Direction number table
+#include <numeric>                                 // Initial permutations
+#include <algorithm>                               // Shuffling strata
+#include <random>                                  // Seeded generators
+#include <ranges>                                  // Range views
+#include <sstream>                                 // Error messages
+#include <stdexcept>                               // Standard exceptions
+#include <source_location>                         // Error locations
+#include <fstream>                                 // Reading the range file
+
+#include "ContextSampler.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Method names
+// --------------------------------------------------------------------------
+//
+
+ContextSampler::Method ContextSampler::ByName( std::string_view MethodName )
+{
+  if( MethodName == "Sobol" )    return Method::Sobol;
+  else if( MethodName == "LHS" ) return Method::LatinHypercube;
+  else
+    throw std::invalid_argument( "Unknown sampling method: "
+                                 + std::string( MethodName ) );
+}
+
+// --------------------------------------------------------------------------
+// Metric ranges
+// --------------------------------------------------------------------------
+//
+
+ContextSampler::RangeType
+ContextSampler::ReadRanges( const std::filesystem::path & RangeFile )
+{
+  std::ifstream TheStream( RangeFile );
+  RangeType     TheRanges;
+
+  try
+  {
+    if( !TheStream )
+      throw std::runtime_error( "The file could not be opened" );
+
+    for( const auto & [ TheMetric, TheRange ] : JSON::parse( TheStream ).items() )
+      TheRanges.emplace( TheMetric, std::make_pair( 
+        TheRange.at( 0 ).get< double >(), TheRange.at( 1 ).get< double >() ) );
+  }
+  catch( const std::exception & TheError )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The metric ranges could not be read from " << RangeFile
+                 << ": " << TheError.what();
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  return TheRanges;
+}
+
+// --------------------------------------------------------------------------
+// Sobol sequence
+// --------------------------------------------------------------------------
+//
+// The direction numbers of Joe and Kuo for the dimensions after the first,
+// given as the degree of the primitive polynomial, the coefficients of the
+// polynomial, and the initial direction numbers.
+
+namespace
+{
+  struct SobolParameters
+  {
+    unsigned int                  Degree, Coefficients;
+    std::array< std::uint64_t, 7 > Initial;
+  };
+
+  constexpr std::array< SobolParameters, 20 > JoeKuo{{
+    { 1,  0, { 1 } },
+    { 2,  1, { 1, 3 } },
+    { 3,  1, { 1, 3, 1 } },
+    { 3,  2, { 1, 1, 1 } },
+    { 4,  1, { 1, 1, 3, 3 } },
+    { 4,  4, { 1, 3, 5, 13 } },
+    { 5,  2, { 1, 1, 5, 5, 17 } },
+    { 5,  4, { 1, 1, 5, 5, 5 } },
+    { 5,  7, { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6,  1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7,  1, { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7,  4, { 1, 3, 7, 13, 13, 15, 69 } }
+  }};
+}
+
+// The coordinate of a sample is the exclusive or of the direction numbers
+// of the bits set in the index. The index is offset by one to skip the
+// origin, which is the first point of the sequence.
+
+std::vector< double > ContextSampler::SobolPoint( std::size_t TheIndex ) const
+{
+  constexpr double Scale = 1.0 / static_cast< double >(
+                           std::uint64_t( 1 ) << SobolBits );
+
+  std::vector< double > ThePoint;
+  std::uint64_t SequenceIndex = TheIndex + 1;
+
+  for( const auto & DimensionDirections : Directions )
+  {
+    std::uint64_t Coordinate = 0;
+
+    for( std::size_t Bit = 0; ( SequenceIndex >> Bit ) != 0; Bit++ )
+      if( ( SequenceIndex >> Bit ) & 1 )
+        Coordinate ^= DimensionDirections[ Bit ];
+
+    ThePoint.push_back( static_cast< double >( Coordinate ) * Scale );
+  }
+
+  return ThePoint;
+}
+
+// --------------------------------------------------------------------------
+// Latin hypercube
+// --------------------------------------------------------------------------
+//
+// The coordinate is the position of the sample in the stratum assigned to
+// the sample.
+
+std::vector< double >
+ContextSampler::HypercubePoint( std::size_t TheIndex ) const
+{
+  std::vector< double > ThePoint;
+
+  for( std::size_t Dimension = 0; Dimension < Strata.size(); Dimension++ )
+    ThePoint.push_back(
+      ( static_cast< double >( Strata[ Dimension ][ TheIndex ] )
+        + Offsets[ Dimension ][ TheIndex ] )
+      / static_cast< double >( NumberOfSamples ) );
+
+  return ThePoint;
+}
+
+// --------------------------------------------------------------------------
+// Samples
+// --------------------------------------------------------------------------
+//
+// The metrics are taken in the order of their names, which is the order of
+// the dimensions of the sample.
+
+Solver::MetricValueType ContextSampler::Sample( std::size_t TheIndex ) const
+{
+  if( TheIndex >= NumberOfSamples )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The sample index " << TheIndex << " is larger than the "
+                 << "number of samples " << NumberOfSamples;
+
+    throw std::out_of_range( ErrorMessage.str() );
+  }
+
+  std::vector< double > ThePoint = ( SamplingMethod == Method::Sobol )
+                                 ? SobolPoint( TheIndex )
+                                 : HypercubePoint( TheIndex );
+
+  Solver::MetricValueType TheSample;
+
+  for( const auto & [ TheRange, Coordinate ] :
+       std::views::zip( Ranges, ThePoint ) )
+  {
+    const auto & [ LowerBound, UpperBound ] = TheRange.second;
+
+    TheSample[ TheRange.first ]
+      = LowerBound + Coordinate * ( UpperBound - LowerBound );
+  }
+
+  return TheSample;
+}
+
+JSON ContextSampler::Settings( void ) const
+{
+  JSON TheSettings{ 
+    { "Method",  SamplingMethod == Method::Sobol ? "Sobol" : "LHS" },
+    { "Samples", NumberOfSamples },
+    { "Ranges",  JSON::object() } };
+
+  for( const auto & [ TheMetric, TheRange ] : Ranges )
+    TheSettings[ "Ranges" ][ TheMetric ] = { TheRange.first, TheRange.second };
+
+  if( SamplingMethod == Method::LatinHypercube )
+    TheSettings[ "Seed" ] = SamplingSeed;
+
+  return TheSettings;
+}
+
+// --------------------------------------------------------------------------
+// Constructor
+// --------------------------------------------------------------------------
+//
+// The Sobol direction numbers of the first dimension are the powers of two,
+// and the direction numbers of the other dimensions are given by the
+// recurrence of the primitive polynomial of the dimension. The Latin
+// hypercube uses one generator for all dimensions so that the samples depend
+// only on the seed, the number of metrics and the number of samples.
+
+ContextSampler::ContextSampler( const RangeType & TheRanges, Method TheMethod,
+                                std::size_t TheNumberOfSamples,
+                                std::uint64_t Seed )
+: Ranges( TheRanges ), SamplingMethod( TheMethod ),
+  NumberOfSamples( TheNumberOfSamples ), SamplingSeed( Seed ),
+  Directions(), Strata(), Offsets()
+{
+  std::ostringstream Problems;
+
+  for( const auto & [ TheMetric, TheRange ] : Ranges )
+    if( !( TheRange.first <= TheRange.second ) )
+      Problems << " The range of " << TheMetric << " is empty.";
+
+  if( ( SamplingMethod == Method::Sobol ) &&
+      ( Ranges.size() > JoeKuo.size() + 1 ) )
+    Problems << " The Sobol sequence supports at most "
+             << JoeKuo.size() + 1 << " metrics, and there are "
+             << Ranges.size() << " metrics.";
+
+  if( !Problems.str().empty() )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The context sampler cannot be created:"
+                 << Problems.str();
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+
+  if( SamplingMethod == Method::Sobol )
+    for( std::size_t Dimension = 0; Dimension < Ranges.size(); Dimension++ )
+    {
+      std::vector< std::uint64_t > V( SobolBits );
+
+      if( Dimension == 0 )
+        for( std::size_t k = 0; k < SobolBits; k++ )
+          V[ k ] = std::uint64_t( 1 ) << ( SobolBits - 1 - k );
+      else
+      {
+        const SobolParameters & P = JoeKuo[ Dimension - 1 ];
+
+        for( std::size_t k = 0; k < P.Degree; k++ )
+          V[ k ] = P.Initial[ k ] << ( SobolBits - 1 - k );
+
+        for( std::size_t k = P.Degree; k < SobolBits; k++ )
+        {
+          V[ k ] = V[ k - P.Degree ] ^ ( V[ k - P.Degree ] >> P.Degree );
+
+          for( std::size_t j = 1; j < P.Degree; j++ )
+            if( ( P.Coefficients >> ( P.Degree - 1 - j ) ) & 1 )
+              V[ k ] ^= V[ k - j ];
+        }
+      }
+
+      Directions.push_back( V );
+    }
+  else
+  {
+    std::mt19937_64 Generator( Seed );
+    std::uniform_real_distribution< double > Uniform( 0.0, 1.0 );
+
+    for( std::size_t Dimension = 0; Dimension < Ranges.size(); Dimension++ )
+    {
+      std::vector< std::size_t > TheStrata( NumberOfSamples );
+      std::vector< double >      TheOffsets( NumberOfSamples );
+
+      std::iota( TheStrata.begin(), TheStrata.end(), 0 );
+      std::ranges::shuffle( TheStrata, Generator );
+      std::ranges::generate( TheOffsets,
+                             [&](){ return Uniform( Generator ); } );
+
+      Strata.push_back( TheStrata );
+      Offsets.push_back( TheOffsets );
+    }
+  }
+}
+
+}      // namespace NebulOuS
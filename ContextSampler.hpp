@@ -0,0 +1,142 @@
+/*==============================================================================
+Context Sampler
+
+Training sets for the machine learning models estimating the application's
+performance indicators are made by solving the optimisation problem for many
+hypothetical application execution contexts. The contexts should cover the
+space of metric values evenly with as few samples as possible, and random
+sampling leaves gaps and clusters unless the number of samples is very large.
+The Context Sampler produces space-filling samples over the declared range of
+each metric using one of two methods:
+
+Sobol: The low-discrepancy sequence of Sobol [1] with the direction numbers of
+       Joe and Kuo [2]. The sample with a given index is always the same, and
+       any prefix of the sequence covers the space evenly. The direction
+       numbers are included for up to 21 metrics.
+LHS:   Latin hypercube sampling [3] dividing the range of each metric into as
+       many strata as there are samples, and each stratum is used by exactly
+       one sample. The strata are assigned by random permutations drawn from
+       a seeded generator so that the samples can be reproduced.
+
+The samples are given by their index so that a partially completed training
+set can be resumed by generating only the samples not yet solved.
+
+References:
+[1] I. M. Sobol': "On the distribution of points in a cube and the approximate
+    evaluation of integrals", USSR Computational Mathematics and Mathematical
+    Physics, Vol. 7, No. 4, pp. 86-112, 1967
+[2] https://web.maths.unsw.edu.au/~fkuo/sobol/
+[3] https://en.wikipedia.org/wiki/Latin_hypercube_sampling
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_CONTEXT_SAMPLER
+#define NEBULOUS_CONTEXT_SAMPLER
+
+// Standard headers
+
+#include <string_view>                          // Method names
+#include <string>                               // Standard strings
+#include <vector>                               // Samples and directions
+#include <map>                                  // Metric ranges
+#include <utility>                              // Pairs
+#include <cstdint>                              // Direction numbers
+#include <cstddef>                              // Sample indices
+#include <filesystem>                           // The range file
+
+// NebulOuS headers
+
+#include "Solver.hpp"                           // Metric value types
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Context Sampler
+
+==============================================================================*/
+
+class ContextSampler
+{
+public:
+
+  enum class Method
+  {
+    Sobol,
+    LatinHypercube
+  };
+
+  // The method is given by name on the command line, and an invalid argument
+  // exception is thrown for unknown names.
+
+  static Method ByName( std::string_view MethodName );
+
+  // The range of each metric is given as the lower and upper bound of the
+  // values of the metric.
+
+  using RangeType = std::map< std::string, std::pair< double, double > >;
+
+  // The ranges can be read from a JSON file holding an object whose keys are
+  // the metric names and whose values are arrays with the lower and the upper
+  // bound, for instance { "Load": [0, 100] }. A runtime error is thrown if
+  // the file cannot be read or parsed.
+
+  static RangeType ReadRanges( const std::filesystem::path & RangeFile );
+
+private:
+
+  const RangeType     Ranges;
+  const Method        SamplingMethod;
+  const std::size_t   NumberOfSamples;
+  const std::uint64_t SamplingSeed;
+
+  // The Sobol direction numbers are computed for each dimension by the
+  // constructor, and the Latin hypercube strata and offsets are drawn for
+  // all samples by the constructor.
+
+  static constexpr std::size_t SobolBits = 52;
+
+  std::vector< std::vector< std::uint64_t > > Directions;
+  std::vector< std::vector< std::size_t > >   Strata;
+  std::vector< std::vector< double > >        Offsets;
+
+  // The unit cube coordinates of a sample are mapped to the metric ranges.
+
+  std::vector< double > SobolPoint( std::size_t TheIndex ) const;
+  std::vector< double > HypercubePoint( std::size_t TheIndex ) const;
+
+public:
+
+  // The sample with the given index is returned as metric values for the
+  // execution context. An out of range exception is thrown if the index is
+  // larger than the number of samples.
+
+  Solver::MetricValueType Sample( std::size_t TheIndex ) const;
+
+  std::size_t size( void ) const
+  { return NumberOfSamples; }
+
+  // The settings defining the samples are returned as a JSON object with the
+  // method name, the number of samples, the ranges, and the seed if the 
+  // method is the Latin hypercube since the Sobol sequence has no seed. Two
+  // samplers with the same settings produce the same samples.
+
+  JSON Settings( void ) const;
+
+  // The constructor takes the metric ranges, the method, the number of
+  // samples and the seed for the Latin hypercube permutations. An invalid
+  // argument exception is thrown if there are more metrics than supported by
+  // the Sobol sequence or if a range is empty.
+
+  ContextSampler( const RangeType & TheRanges, Method TheMethod,
+                  std::size_t TheNumberOfSamples, std::uint64_t Seed );
+
+  ContextSampler( const ContextSampler & Other ) = default;
+  ~ContextSampler() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_CONTEXT_SAMPLER
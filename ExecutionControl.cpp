@@ -50,18 +50,22 @@ void ExecutionControl::WaitForTermination( void )
 //
 // The stop message handler will first send the network stop message to the 
 // session layer requesting it to coordinate the network shutdown and close all
-// externally communicating actors. 
+// externally communicating actors. There is no network in batch mode, and the
+// actor system then just terminates.
 
 void ExecutionControl::StopMessageHandler( const StopMessage & Command, 
                                            const Address Sender )
 {
   std::lock_guard< std::mutex > Lock( TerminationLock );
 
-  Send( StatusMessage( StatusMessage::State::Stopped ), 
-                       Address( StatusMessage::AMQTopic ) );
+  if( HasNetwork() )
+  {
+    Send( StatusMessage( StatusMessage::State::Stopped ), 
+                         Address( StatusMessage::AMQTopic ) );
 
-  Send( Theron::Network::ShutDown(), 
-        Theron::Network::GetAddress( Theron::Network::Layer::Session ) );
+    Send( Theron::Network::ShutDown(), 
+          Theron::Network::GetAddress( Theron::Network::Layer::Session ) );
+  }
 
   Running = false;
   ReadyToTerminate.notify_all();
@@ -73,6 +77,7 @@ void ExecutionControl::StopMessageHandler( const StopMessage & Command,
 // 
 // The constructor registers the stop message handler and sets up a publisher 
 // for the status topic, and then post a message that the solver is starting.
+// The status is not published in batch mode where there is no network.
 
 ExecutionControl::ExecutionControl( const std::string & TheActorName )
 : Actor( TheActorName ),
@@ -81,14 +86,16 @@ ExecutionControl::ExecutionControl( const std::string & TheActorName )
 {
   RegisterHandler( this, &ExecutionControl::StopMessageHandler );
 
-  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
-    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher,
-    StatusMessage::AMQTopic
-  ), GetSessionLayerAddress() );
-
-  Send( StatusMessage( StatusMessage::State::Starting ), 
-        Address( StatusMessage::AMQTopic ) );
+  if( HasNetwork() )
+  {
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher,
+      StatusMessage::AMQTopic
+    ), GetSessionLayerAddress() );
 
+    Send( StatusMessage( StatusMessage::State::Starting ), 
+          Address( StatusMessage::AMQTopic ) );
+  }
 }
 
 // The destructor simply closes the publisher if the network is still active
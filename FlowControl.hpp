@@ -0,0 +1,114 @@
+/*==============================================================================
+Flow Control
+
+The AMQ links receiving messages from the broker are given a credit window by
+the Qpid Proton library, which is the number of messages the broker may send
+on the link before the receiver has processed them, i.e. the prefetch of the
+link. The credit is given per link, and since each topic subscription has its
+own link, the credit window bounds how many messages of one topic can be
+outstanding at any time. A large window gives a high throughput for topics with
+many small messages, like the metric predictions, whereas a small window keeps
+the backlog of each link short so that a flood on one topic does not delay the
+messages on the other topics.
+
+The flow control policy sets the credit window and the delivery mode of the
+receiving links. Messages received with the at-most-once delivery mode are
+settled by the broker when they are sent, and they are not acknowledged by the
+receiver. This would be sensible for high-rate metric predictions where a lost
+value is replaced by the next prediction, but the control messages like the
+optimisation problem and the SLO violations must be delivered at least once.
+The Theron++ network layer asks for the same receiver options for all links,
+and the topic of the link is not known when the options are given. The presets
+therefore never use at-most-once delivery since it would apply also to the
+control links.
+
+There are three presets:
+
+Default:  The library defaults are used for all links
+HighRate: A large credit window and at-least-once delivery for deployments
+          where the metric predictions dominate the traffic
+LowRate:  A small credit window and at-least-once delivery for deployments
+          where the control messages should never wait behind other messages
+
+The credit window of the preset can be overridden by an explicit value.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_FLOW_CONTROL
+#define NEBULOUS_FLOW_CONTROL
+
+// Standard headers
+
+#include <string_view>                          // Constant strings
+#include <string>                               // Standard strings
+#include <optional>                             // Optional settings
+#include <stdexcept>                            // Unknown preset names
+
+// Other packages
+
+#include "proton/receiver_options.hpp"          // Link options
+#include "proton/delivery_mode.hpp"             // Settlement modes
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Flow control policy
+
+==============================================================================*/
+//
+// The settings not given are left at the library defaults.
+
+class FlowControlPolicy
+{
+public:
+
+  std::optional< int >                   CreditWindow;
+  std::optional< proton::delivery_mode > Delivery;
+
+  // The presets are given by name on the command line, and an invalid
+  // argument exception is thrown for unknown names.
+
+  static FlowControlPolicy ByName( std::string_view PresetName )
+  {
+    if( PresetName == "Default" )
+      return FlowControlPolicy();
+    else if( PresetName == "HighRate" )
+      return FlowControlPolicy( 1000, proton::delivery_mode::AT_LEAST_ONCE );
+    else if( PresetName == "LowRate" )
+      return FlowControlPolicy( 10, proton::delivery_mode::AT_LEAST_ONCE );
+    else
+      throw std::invalid_argument( "Unknown flow control preset: "
+                                   + std::string( PresetName ) );
+  }
+
+  // The policy is applied to the options of a receiving link
+
+  proton::receiver_options Apply( proton::receiver_options TheOptions ) const
+  {
+    if( CreditWindow ) TheOptions.credit_window( *CreditWindow );
+    if( Delivery )     TheOptions.delivery_mode( *Delivery );
+
+    return TheOptions;
+  }
+
+  // Constructors
+
+  FlowControlPolicy( int TheCreditWindow,
+                     proton::delivery_mode TheDeliveryMode )
+  : CreditWindow( TheCreditWindow ), Delivery( TheDeliveryMode )
+  {}
+
+  FlowControlPolicy( void )
+  : CreditWindow(), Delivery()
+  {}
+
+  FlowControlPolicy( const FlowControlPolicy & Other ) = default;
+  ~FlowControlPolicy() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_FLOW_CONTROL
@@ -0,0 +1,451 @@
+/*==============================================================================
+Local Query Server
+
+This file implements the Unix domain socket serving the application execution
+contexts submitted by co-located clients and returning their solutions. Please
+see the header file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <vector>                                  // Poll descriptors
+#include <array>                                   // Receive buffer
+#include <sstream>                                 // Error messages
+#include <stdexcept>                               // Standard exceptions
+#include <source_location>                         // Error locations
+#include <cstring>                                 // Socket path copy
+#include <cerrno>                                  // System errors
+#include <ranges>                                  // Connection values
+#include <system_error>                            // System error messages
+
+// POSIX headers
+
+#include <sys/socket.h>                            // Sockets
+#include <sys/un.h>                                // Unix domain sockets
+#include <sys/eventfd.h>                           // Waking the thread
+#include <poll.h>                                  // Waiting for data
+#include <unistd.h>                                // Closing sockets
+
+#include "Utility/ConsolePrint.hpp"                // For logging
+
+#include "LocalQueryServer.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Contexts
+// --------------------------------------------------------------------------
+//
+// The line is parsed as an application execution context. The client's
+// correlation identifier is replaced by the server's request identifier, and
+// the reply address is set to this actor with the request identifier so that
+// the solution can be routed back to the connection. Lines that cannot be
+// parsed or do not form valid contexts are answered with an error.
+
+void LocalQueryServer::SubmitContext( std::uint64_t ConnectionID,
+                                      std::string_view TheLine )
+{
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+
+  if( TheLine.find_first_not_of( " \t\r" ) == std::string_view::npos )
+    return;
+
+  try
+  {
+    Solver::ApplicationExecutionContext TheContext;
+    JSON & TheObject( TheContext );
+
+    TheObject = JSON::parse( TheLine );
+
+    const Solver::ApplicationExecutionContext::View & TheView 
+                                                    = TheContext.GetView();
+
+    std::string RequestID = std::to_string( ConnectionID ) + "/"
+                          + std::to_string( ++RequestCounter );
+
+    Request TheRequest{ ConnectionID, std::nullopt };
+
+    if( TheView.Has< Keys::CorrelationID >() )
+      TheRequest.ClientCorrelation = TheView.Get< Keys::CorrelationID >();
+
+    TheContext.Set< Keys::CorrelationID >( RequestID );
+    TheContext.Set< Keys::ReplyTo >(
+      std::string( Solver::ApplicationExecutionContext::LocalReply )
+      + GetAddress().AsString() + "#" + std::to_string( ConnectionID ) );
+
+    PendingRequests.emplace( RequestID, TheRequest );
+    Send( TheContext, SolverManager );
+  }
+  catch( const std::exception & TheError )
+  {
+    WriteLine( ConnectionID, JSON{ { "Error", TheError.what() } }.dump() );
+  }
+}
+
+void LocalQueryServer::SubmitContexts( const ReceivedLines & TheLines,
+                                       const Address TheServer )
+{
+  for( const std::string & TheLine : TheLines.Lines )
+    SubmitContext( TheLines.ConnectionID, TheLine );
+}
+
+// The requests of a closed connection are forgotten, and their solutions 
+// will be ignored when they arrive.
+
+void LocalQueryServer::ForgetRequests( const ConnectionClosed & TheConnection,
+                                       const Address TheServer )
+{
+  std::erase_if( PendingRequests, [&]( const auto & TheRequest ){
+    return TheRequest.second.ConnectionID == TheConnection.ConnectionID; });
+}
+
+// The line is put in the outbox, and the socket thread is woken by 
+// incrementing the event counter.
+
+void LocalQueryServer::WriteLine( std::uint64_t ConnectionID, 
+                                  std::string && TheLine )
+{
+  {
+    std::lock_guard< std::mutex > Lock( Outbox );
+    OutboxLines.emplace_back( ConnectionID, std::move( TheLine ) );
+  }
+
+  eventfd_write( WakeUp, 1 );
+}
+
+// --------------------------------------------------------------------------
+// Socket thread
+// --------------------------------------------------------------------------
+//
+// The received text is split into complete lines that are sent together to
+// the actor. False is returned if the connection is closed by the client or
+// has failed.
+
+bool LocalQueryServer::ReadConnection( std::uint64_t ConnectionID,
+                                       Connection & TheConnection )
+{
+  std::array< char, 4096 > Buffer;
+  ssize_t Received = recv( TheConnection.Socket, Buffer.data(), 
+                           Buffer.size(), 0 );
+
+  if( ( Received < 0 ) && 
+      ( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) || 
+        ( errno == EINTR ) ) )
+    return true;
+  else if( Received <= 0 )
+    return false;
+
+  std::string & TheText = TheConnection.Received;
+  std::vector< std::string > TheLines;
+
+  TheText.append( Buffer.data(), Received );
+
+  for( std::size_t LineEnd = TheText.find( '\n' );
+       LineEnd != std::string::npos; LineEnd = TheText.find( '\n' ) )
+  {
+    TheLines.push_back( TheText.substr( 0, LineEnd ) );
+    TheText.erase( 0, LineEnd + 1 );
+  }
+
+  if( !TheLines.empty() )
+    Send( ReceivedLines( ConnectionID, std::move( TheLines ) ), GetAddress() );
+
+  return true;
+}
+
+// As much of the unsent output as the socket accepts is written. False is 
+// returned if the connection has failed. The broken pipe signal is 
+// suppressed so that a client closing its connection does not terminate the
+// Solver Component.
+
+bool LocalQueryServer::FlushConnection( Connection & TheConnection )
+{
+  while( !TheConnection.Unsent.empty() )
+  {
+    ssize_t Result = send( TheConnection.Socket, TheConnection.Unsent.data(),
+                           TheConnection.Unsent.size(), MSG_NOSIGNAL );
+
+    if( Result < 0 )
+    {
+      if( errno == EINTR ) continue;
+      else return ( errno == EAGAIN ) || ( errno == EWOULDBLOCK );
+    }
+    else
+      TheConnection.Unsent.erase( 0, static_cast< std::size_t >( Result ) );
+  }
+
+  return true;
+}
+
+// Closing a connection tells the actor to forget the requests of the 
+// connection.
+
+void LocalQueryServer::CloseConnection( std::uint64_t ConnectionID )
+{
+  auto TheConnection = Connections.find( ConnectionID );
+
+  if( TheConnection != Connections.end() )
+  {
+    close( TheConnection->second.Socket );
+    Connections.erase( TheConnection );
+    Send( ConnectionClosed( ConnectionID ), GetAddress() );
+  }
+}
+
+// The outbox is emptied into the unsent output of the connections before 
+// each poll, and the connections with unsent output are written. The poll 
+// set is then rebuilt with the wake-up descriptor and the listening socket 
+// first, and the connections with unsent output also wait for the socket to
+// accept more output. New connections are accepted as non-blocking sockets.
+
+void LocalQueryServer::ServeSocket( std::stop_token StopRequest )
+{
+  std::vector< std::pair< std::uint64_t, std::string > > TheLines;
+  std::vector< pollfd >        Descriptors;
+  std::vector< std::uint64_t > Identifiers, Failed;
+
+  while( !StopRequest.stop_requested() )
+  {
+    {
+      std::lock_guard< std::mutex > Lock( Outbox );
+      TheLines.swap( OutboxLines );
+    }
+
+    for( auto & [ ConnectionID, TheLine ] : TheLines )
+      if( auto TheConnection = Connections.find( ConnectionID );
+          TheConnection != Connections.end() )
+        TheConnection->second.Unsent.append( TheLine ).push_back( '\n' );
+
+    TheLines.clear();
+
+    for( auto & [ ConnectionID, TheConnection ] : Connections )
+      if( !FlushConnection( TheConnection ) || 
+          ( TheConnection.Unsent.size() > OutputLimit ) )
+        Failed.push_back( ConnectionID );
+
+    for( std::uint64_t ConnectionID : Failed )
+      CloseConnection( ConnectionID );
+
+    Failed.clear();
+    Descriptors.clear();
+    Identifiers.clear();
+
+    Descriptors.push_back( pollfd{ WakeUp, POLLIN, 0 } );
+    Descriptors.push_back( pollfd{ ListeningSocket, POLLIN, 0 } );
+
+    for( const auto & [ ConnectionID, TheConnection ] : Connections )
+    {
+      short Events = TheConnection.Unsent.empty() ? POLLIN 
+                                                  : ( POLLIN | POLLOUT );
+
+      Descriptors.push_back( pollfd{ TheConnection.Socket, Events, 0 } );
+      Identifiers.push_back( ConnectionID );
+    }
+
+    if( poll( Descriptors.data(), Descriptors.size(), -1 ) <= 0 ) continue;
+
+    if( Descriptors[ 0 ].revents & POLLIN )
+    {
+      eventfd_t Ignored;
+      eventfd_read( WakeUp, &Ignored );
+    }
+
+    if( Descriptors[ 1 ].revents & POLLIN )
+      for( int NewSocket = accept4( ListeningSocket, nullptr, nullptr, 
+                                    SOCK_NONBLOCK );
+           NewSocket >= 0; 
+           NewSocket = accept4( ListeningSocket, nullptr, nullptr, 
+                                SOCK_NONBLOCK ) )
+        Connections.emplace( ++ConnectionCounter,
+                             Connection{ NewSocket, {}, {} } );
+
+    for( std::size_t i = 2; i < Descriptors.size(); i++ )
+      if( Descriptors[ i ].revents & ( POLLIN | POLLHUP | POLLERR ) )
+      {
+        std::uint64_t ConnectionID = Identifiers[ i - 2 ];
+
+        if( !ReadConnection( ConnectionID, Connections.at( ConnectionID ) ) )
+          CloseConnection( ConnectionID );
+      }
+  }
+}
+
+// --------------------------------------------------------------------------
+// Solutions
+// --------------------------------------------------------------------------
+//
+// The server's request identifier is replaced with the client's correlation
+// identifier, and the reply address is removed before the solution is
+// written to the connection. A failed solution is written as an error object
+// with the client's correlation identifier. A predicted solution is followed
+// by the exact solution for the same request, and the request is only 
+// completed by the exact solution. Solutions for unknown requests, for 
+// instance if the connection has been closed, are ignored.
+
+void LocalQueryServer::RouteSolution( JSON TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  auto TheRequest = PendingRequests.find(
+    TheSolution.value( Keys::CorrelationID, std::string() ) );
+
+  if( TheRequest == PendingRequests.end() ) return;
+
+  if( TheRequest->second.ClientCorrelation )
+    TheSolution[ Keys::CorrelationID ] = *TheRequest->second.ClientCorrelation;
+  else
+    TheSolution.erase( Keys::CorrelationID );
+
+  TheSolution.erase( Keys::ReplyTo );
+
+  if( TheSolution.contains( Keys::Error ) )
+  {
+    JSON TheError{ { Keys::Error, TheSolution.at( Keys::Error ) } };
+
+    if( TheSolution.contains( Keys::CorrelationID ) )
+      TheError[ Keys::CorrelationID ] = TheSolution.at( Keys::CorrelationID );
+
+    TheSolution = TheError;
+  }
+
+  std::uint64_t ConnectionID = TheRequest->second.ConnectionID;
+
+  if( !TheSolution.value( Keys::Predicted, false ) )
+    PendingRequests.erase( TheRequest );
+
+  WriteLine( ConnectionID, TheSolution.dump() );
+}
+
+void LocalQueryServer::ReturnSolution( const Solver::Solution & TheSolution,
+                                       const Address TheSolverManager )
+{
+  RouteSolution( TheSolution );
+}
+
+void LocalQueryServer::ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                                    const Address TheSolverManager )
+{
+  for( const JSON & TheSolution :
+       TheBatch.at( Solver::SolutionBatch::Keys::Solutions ) )
+    RouteSolution( TheSolution );
+}
+
+// --------------------------------------------------------------------------
+// Constructor and destructor
+// --------------------------------------------------------------------------
+//
+
+LocalQueryServer::LocalQueryServer( const std::string & TheActorName,
+                                    const std::filesystem::path & TheSocketPath,
+                                    const Address & TheSolverManager )
+: Actor( TheActorName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() ),
+  SocketPath( TheSocketPath ), SolverManager( TheSolverManager ),
+  PendingRequests(), RequestCounter( 0 ), Outbox(), OutboxLines(),
+  Connections(), ConnectionCounter( 0 ),
+  ListeningSocket( socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0 ) ),
+  WakeUp( eventfd( 0, EFD_NONBLOCK ) ), SocketThread()
+{
+  sockaddr_un SocketAddress{};
+  SocketAddress.sun_family = AF_UNIX;
+
+  if( WakeUp < 0 )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The wake-up event of the local query socket could not "
+                 << "be created: " << std::system_category().message( errno );
+
+    if( ListeningSocket >= 0 ) close( ListeningSocket );
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  if( ( SocketPath.native().size() >= sizeof( SocketAddress.sun_path ) ) ||
+      ( ListeningSocket < 0 ) )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The local query socket " << SocketPath
+                 << " could not be created: "
+                 << ( ListeningSocket < 0
+                      ? std::system_category().message( errno )
+                      : std::string( "The path is too long" ) );
+
+    if( ListeningSocket >= 0 ) close( ListeningSocket );
+    close( WakeUp );
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  std::strncpy( SocketAddress.sun_path, SocketPath.c_str(),
+                sizeof( SocketAddress.sun_path ) - 1 );
+
+  std::filesystem::remove( SocketPath );
+
+  if( ( bind( ListeningSocket,
+              reinterpret_cast< sockaddr * >( &SocketAddress ),
+              sizeof( SocketAddress ) ) < 0 ) ||
+      ( listen( ListeningSocket, SOMAXCONN ) < 0 ) )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The local query socket " << SocketPath
+                 << " could not be opened: "
+                 << std::system_category().message( errno );
+
+    close( ListeningSocket );
+    close( WakeUp );
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  RegisterHandler( this, &LocalQueryServer::ReturnSolution );
+  RegisterHandler( this, &LocalQueryServer::ReturnBatch    );
+  RegisterHandler( this, &LocalQueryServer::SubmitContexts );
+  RegisterHandler( this, &LocalQueryServer::ForgetRequests );
+
+  SocketThread = std::jthread( [this]( std::stop_token StopRequest ){ 
+    ServeSocket( StopRequest ); } );
+
+  Theron::ConsoleOutput Output;
+  Output << "Local Query Server listening on " << SocketPath << std::endl;
+}
+
+// The destructor stops the socket thread and waits for it to end before the 
+// listening socket and the open connections are closed.
+
+LocalQueryServer::~LocalQueryServer()
+{
+  SocketThread.request_stop();
+  eventfd_write( WakeUp, 1 );
+
+  if( SocketThread.joinable() ) SocketThread.join();
+
+  close( WakeUp );
+  close( ListeningSocket );
+
+  for( const auto & TheConnection : std::views::values( Connections ) )
+    close( TheConnection.Socket );
+
+  std::error_code Ignored;
+  std::filesystem::remove( SocketPath, Ignored );
+}
+
+} // End name space NebulOuS
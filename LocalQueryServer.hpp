@@ -0,0 +1,226 @@
+/*==============================================================================
+Local Query Server
+
+Other NebulOuS services running on the same node as the Solver Component, for
+instance the utility evaluator or a simulator, may submit many hypothetical
+application execution contexts to find the optimal configuration for each of
+them. Sending each request and solution through the AMQ broker adds the round
+trip to the broker to the latency of every request and loads the broker with
+messages that never leave the node.
+
+The Local Query Server offers a Unix domain socket where co-located clients can
+submit application execution contexts directly. The protocol is line based:
+Each line sent by the client is one application execution context message in
+JSON format, and each line returned is one solution message in JSON format, or
+an error object with the key "Error" if the line could not be accepted or if
+no solution could be found for the context. The contexts are sent to the
+Solver Manager and queued together with the contexts received from the AMQ
+broker, and the solutions are returned by the Solver Manager to this actor,
+which writes them back on the connection that submitted the context. The client's correlation identifier is returned with the solution
+so that a client may have many outstanding requests on one connection.
+
+The socket is served by a separate thread that owns the listening socket and
+the connections. The thread waits without a timeout for new connections, for
+inbound data, for connections ready to take more output, and for a wake-up
+signalled by the actor when there are solutions to write. The complete lines
+received are sent as a message to the actor, which parses them and submits
+the contexts, and the solution lines are handed back to the thread through an
+outbox protected by a mutex. The request table is therefore only used by the
+actor, and the sockets only by the thread. The sockets do not block, and the
+output for each connection is buffered until the client reads it. A client
+that lets too much unread output accumulate is disconnected so that it cannot
+exhaust the memory of the Solver Component.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_LOCAL_QUERY_SERVER
+#define NEBULOUS_LOCAL_QUERY_SERVER
+
+// Standard headers
+
+#include <string>                               // Standard strings
+#include <string_view>                          // Constant strings
+#include <filesystem>                           // The socket path
+#include <unordered_map>                        // Connections and requests
+#include <vector>                               // Received and output lines
+#include <utility>                              // Output line pairs
+#include <optional>                             // Client correlation
+#include <cstdint>                              // Request numbers
+#include <cstddef>                              // Output sizes
+#include <mutex>                                // Outbox lock
+#include <thread>                               // The socket thread
+#include <stop_token>                           // Stopping the thread
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// Theron++ headers
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+
+// NebulOuS headers
+
+#include "Solver.hpp"                           // Context and solution messages
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Local Query Server
+
+==============================================================================*/
+
+class LocalQueryServer
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler
+{
+  // --------------------------------------------------------------------------
+  // Requests
+  // --------------------------------------------------------------------------
+  //
+  // The requests are identified by a correlation identifier assigned by the
+  // server and recorded with the connection of the request and the client's
+  // own correlation identifier, if any. The connections are identified by a
+  // sequence number assigned by the socket thread that is never reused.
+
+private:
+
+  const std::filesystem::path SocketPath;
+  const Address               SolverManager;
+
+  struct Request
+  {
+    std::uint64_t                ConnectionID;
+    std::optional< JSON >        ClientCorrelation;
+  };
+
+  std::unordered_map< std::string, Request > PendingRequests;
+  std::uint64_t RequestCounter;
+
+  // The lines received on a connection are sent by the socket thread to the
+  // actor, and each line is handled as a context submitted by the client of 
+  // the connection. The socket thread also tells the actor when a connection
+  // has been closed so that the requests of the connection are forgotten.
+
+  class ReceivedLines
+  {
+  public:
+
+    const std::uint64_t              ConnectionID;
+    const std::vector< std::string > Lines;
+
+    ReceivedLines( std::uint64_t TheConnection, 
+                   std::vector< std::string > && TheLines )
+    : ConnectionID( TheConnection ), Lines( std::move( TheLines ) )
+    {}
+
+    ReceivedLines( const ReceivedLines & Other ) = default;
+    ~ReceivedLines() = default;
+  };
+
+  class ConnectionClosed
+  {
+  public:
+
+    const std::uint64_t ConnectionID;
+
+    ConnectionClosed( std::uint64_t TheConnection )
+    : ConnectionID( TheConnection )
+    {}
+
+    ConnectionClosed( const ConnectionClosed & Other ) = default;
+    ~ConnectionClosed() = default;
+  };
+
+  void SubmitContexts( const ReceivedLines & TheLines, 
+                       const Address TheServer );
+  void SubmitContext( std::uint64_t ConnectionID, std::string_view TheLine );
+  void ForgetRequests( const ConnectionClosed & TheConnection, 
+                       const Address TheServer );
+
+  // The actor writes a line to a connection by putting it in the outbox and
+  // waking the socket thread. Lines for connections that have been closed
+  // are dropped by the socket thread.
+
+  std::mutex Outbox;
+  std::vector< std::pair< std::uint64_t, std::string > > OutboxLines;
+
+  void WriteLine( std::uint64_t ConnectionID, std::string && TheLine );
+
+  // --------------------------------------------------------------------------
+  // Socket thread
+  // --------------------------------------------------------------------------
+  //
+  // Each connection holds the socket file descriptor, the text received that
+  // does not yet form a complete line, and the output not yet accepted by 
+  // the socket. The connections are only used by the socket thread. The 
+  // wake-up descriptor is an event counter signalled by the actor when lines
+  // are put in the outbox, and by the destructor to stop the thread.
+
+  struct Connection
+  {
+    int         Socket;
+    std::string Received, Unsent;
+  };
+
+  std::unordered_map< std::uint64_t, Connection > Connections;
+  std::uint64_t ConnectionCounter;
+  int           ListeningSocket, WakeUp;
+
+  // A client is disconnected if its unsent output exceeds the output limit.
+
+  static constexpr std::size_t OutputLimit = 16 * 1024 * 1024;
+
+  std::jthread SocketThread;
+
+  void ServeSocket( std::stop_token StopRequest );
+  bool ReadConnection( std::uint64_t ConnectionID, Connection & TheConnection );
+  bool FlushConnection( Connection & TheConnection );
+  void CloseConnection( std::uint64_t ConnectionID );
+
+  // --------------------------------------------------------------------------
+  // Solutions
+  // --------------------------------------------------------------------------
+  //
+  // The solutions are routed back to the connection of the request. Batches
+  // of solutions are split and each solution is routed individually, and a
+  // failed solution is returned as an error object.
+
+  void ReturnSolution( const Solver::Solution & TheSolution,
+                       const Address TheSolverManager );
+
+  void ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                    const Address TheSolverManager );
+
+  void RouteSolution( JSON TheSolution );
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The constructor takes the name of the actor, the path of the socket to
+  // create, and the address of the Solver Manager receiving the contexts. Any
+  // existing file at the socket path is removed before the socket is bound,
+  // and a runtime error is thrown if the socket cannot be created. The
+  // destructor stops the socket thread, closes all connections and removes
+  // the socket file.
+
+public:
+
+  LocalQueryServer( const std::string & TheActorName,
+                    const std::filesystem::path & TheSocketPath,
+                    const Address & TheSolverManager );
+
+  LocalQueryServer( const LocalQueryServer & Other ) = delete;
+
+  virtual ~LocalQueryServer();
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_LOCAL_QUERY_SERVER
@@ -0,0 +1,203 @@
+/*==============================================================================
+Message Encoding
+
+The JSON messages of Theron++ are sent as JSON text, which is the format
+expected by the other NebulOuS components. However, the application execution
+contexts and the solutions can be large and frequent, and the text encoding
+and decoding is then a significant part of the cost of passing the messages.
+The JSON library supports the binary formats Concise Binary Object
+Representation (CBOR) [1] and MessagePack [2] that are both faster to encode
+and decode and more compact than the text representation of the same JSON
+object.
+
+The message classes defined here extend the Theron++ JSON messages with the
+binary encodings. The encoding of a message is signalled to the receiver by
+the AMQP content type property of the message, and the content type of an
+inbound message decides how the message is decoded and is remembered by the
+message. The encoding of an outbound message is text JSON unless another
+encoding is set for the message. This ensures that the messages on the shared
+topics, like the solutions, the status, and the model parameters, can be read
+by all the other NebulOuS components, and the binary encodings are only used
+for replies to requesters that have shown that they support the encoding by
+using it for their requests.
+
+References:
+[1] https://cbor.io/
+[2] https://msgpack.org/
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_MESSAGE_ENCODING
+#define NEBULOUS_MESSAGE_ENCODING
+
+// Standard headers
+
+#include <string_view>                          // Constant strings
+#include <string>                               // Standard strings
+#include <vector>                               // Encoded bytes
+#include <cstdint>                              // Byte type
+#include <memory>                               // Shared payload pointers
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+#include "proton/message.hpp"                   // AMQ message payload
+#include "proton/binary.hpp"                    // Binary message bodies
+#include "proton/value.hpp"                     // Reading message bodies
+
+// AMQ communication headers
+
+#include "Communication/AMQ/AMQjson.hpp"         // The JSON messages
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Encoding formats
+
+==============================================================================*/
+//
+// The formats are identified by their content type strings.
+
+class MessageEncoding
+{
+public:
+
+  enum class Format
+  {
+    JSON,
+    CBOR,
+    MessagePack
+  };
+
+  struct ContentType
+  {
+    static constexpr std::string_view
+      JSON        = "application/json",
+      CBOR        = "application/cbor",
+      MessagePack = "application/msgpack";
+  };
+
+  // Any content type other than the two binary formats is taken to be text
+  // JSON, which is also what the Theron++ JSON messages assume.
+
+  static Format ByContentType( std::string_view TheContentType )
+  {
+    if( TheContentType == ContentType::CBOR )             
+      return Format::CBOR;
+    else if( TheContentType == ContentType::MessagePack ) 
+      return Format::MessagePack;
+    else
+      return Format::JSON;
+  }
+};
+
+/*==============================================================================
+
+ Encoded messages
+
+==============================================================================*/
+//
+// The encoded message extends a Theron++ JSON message. The payload is created
+// directly from the JSON object for the binary formats, and the text encoding
+// of the base class is used otherwise. The inbound payload is decoded from the
+// binary formats if the content type says so, and passed on to the base class
+// for the text format.
+
+template< class JSONMessageType >
+class EncodedMessage
+: public JSONMessageType
+{
+private:
+
+  MessageEncoding::Format Encoding = MessageEncoding::Format::JSON;
+
+protected:
+
+  virtual Theron::AMQ::Message::PayloadType GetPayload( void ) const override
+  {
+    if( Encoding == MessageEncoding::Format::JSON )
+      return JSONMessageType::GetPayload();
+
+    const JSON & TheObject( *this );
+    std::vector< std::uint8_t > Bytes;
+
+    if( Encoding == MessageEncoding::Format::CBOR )
+      Bytes = JSON::to_cbor( TheObject );
+    else
+      Bytes = JSON::to_msgpack( TheObject );
+
+    Theron::AMQ::Message::PayloadType ThePayload
+                                      = std::make_shared< proton::message >();
+
+    ThePayload->body( proton::binary( Bytes.begin(), Bytes.end() ) );
+    ThePayload->content_type( std::string(
+      Encoding == MessageEncoding::Format::CBOR
+      ? MessageEncoding::ContentType::CBOR
+      : MessageEncoding::ContentType::MessagePack ) );
+
+    return ThePayload;
+  }
+
+  virtual bool Initialize(
+    const Theron::AMQ::Message::PayloadType & ThePayload ) noexcept override
+  {
+    const std::string TheContentType( ThePayload->content_type() );
+
+    Encoding = MessageEncoding::ByContentType( TheContentType );
+
+    if( Encoding != MessageEncoding::Format::JSON )
+      try
+      {
+        proton::binary TheBody
+                       = proton::get< proton::binary >( ThePayload->body() );
+        JSON & TheObject( *this );
+
+        if( Encoding == MessageEncoding::Format::CBOR )
+          TheObject = JSON::from_cbor( TheBody.begin(), TheBody.end() );
+        else
+          TheObject = JSON::from_msgpack( TheBody.begin(), TheBody.end() );
+
+        return true;
+      }
+      catch( ... )
+      {
+        return false;
+      }
+    else
+      return JSONMessageType::Initialize( ThePayload );
+  }
+
+  // The encoding of a received message is the encoding used by the sender,
+  // and a reply can be given the same encoding.
+
+public:
+
+  MessageEncoding::Format GetEncoding( void ) const
+  { return Encoding; }
+
+  void SetEncoding( MessageEncoding::Format TheEncoding )
+  { Encoding = TheEncoding; }
+
+  // The constructors are those of the JSON message type.
+
+  using JSONMessageType::JSONMessageType;
+
+  EncodedMessage( const EncodedMessage & Other )
+  : JSONMessageType( Other ), Encoding( Other.Encoding )
+  {}
+
+  virtual ~EncodedMessage() = default;
+};
+
+// The Solver Component messages are topic messages
+
+using TopicMessage = EncodedMessage< Theron::AMQ::JSONTopicMessage >;
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_MESSAGE_ENCODING
@@ -0,0 +1,243 @@
+/*==============================================================================
+Message View
+
+The fields of the JSON messages are read in the message handlers by looking up
+the keys of the message with the 'at' function of the JSON object. Every lookup
+compares the key string with the keys of the message, and a missing field or a
+field of the wrong type throws an exception deep in the handler, possibly
+after the handler has already changed its state. A message view is a typed
+structure decoded from the JSON message once when the message is received. The
+fields of the view are defined at compile time from the key strings of the
+message, and they are accessed by key with the position of the field resolved
+by the compiler. The decoding validates the message: All mandatory fields must
+be present and all fields must have the right type, and otherwise an invalid
+argument exception is thrown listing all the problems of the message.
+
+A view is defined by a list of fields, where each field is given by a reference
+to the key string, the C++ type of the value, and whether the field is
+mandatory, e.g.
+
+using View = MessageView<
+  MessageField< Keys::TimeStamp, TimePointType >,
+  MessageField< Keys::CorrelationID, std::string, false > >;
+
+The value of a field is then read as View.Get< Keys::TimeStamp >().
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_MESSAGE_VIEW
+#define NEBULOUS_MESSAGE_VIEW
+
+// Standard headers
+
+#include <string_view>                          // Constant strings
+#include <string>                               // Standard strings
+#include <tuple>                                // The field values
+#include <utility>                              // Index sequences
+#include <optional>                             // Optional fields
+#include <array>                                // Field names
+#include <cstddef>                              // Field indices
+#include <sstream>                              // Error messages
+#include <stdexcept>                            // Standard exceptions
+#include <source_location>                      // Error locations
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Fields
+
+==============================================================================*/
+//
+// A field is a compile time description of a message field. It has no run
+// time representation.
+
+template< const std::string_view & Key, typename ValueType,
+          bool Mandatory = true >
+struct MessageField
+{
+  using Type = ValueType;
+
+  static constexpr std::string_view Name     = Key;
+  static constexpr bool             Required = Mandatory;
+};
+
+/*==============================================================================
+
+ Message view
+
+==============================================================================*/
+
+template< class... Fields >
+class MessageView
+{
+  // --------------------------------------------------------------------------
+  // Field lookup
+  // --------------------------------------------------------------------------
+  //
+  // The values are stored as optional values in a tuple with one element per
+  // field. The index of a key in the tuple is found at compile time, and it
+  // is a compile error to ask for a key that is not a field of the view.
+
+private:
+
+  std::tuple< std::optional< typename Fields::Type >... > Values;
+
+  static constexpr std::array< std::string_view, sizeof...( Fields ) >
+    FieldNames{ Fields::Name... };
+
+  template< const std::string_view & Key >
+  static constexpr std::size_t Index( void )
+  {
+    for( std::size_t i = 0; i < FieldNames.size(); i++ )
+      if( FieldNames[ i ] == Key ) return i;
+
+    return FieldNames.size();
+  }
+
+  template< const std::string_view & Key >
+  static constexpr std::size_t FieldIndex = Index< Key >();
+
+  // --------------------------------------------------------------------------
+  // Decoding
+  // --------------------------------------------------------------------------
+  //
+  // Each field is decoded from the message, and the problems found are
+  // recorded in the error stream.
+
+  template< class Field, std::size_t FieldNumber >
+  void Decode( const JSON & TheMessage, std::ostringstream & Problems )
+  {
+    auto TheValue = TheMessage.find( Field::Name );
+
+    if( TheValue == TheMessage.end() )
+    {
+      if constexpr ( Field::Required )
+        Problems << " The field \"" << Field::Name << "\" is missing.";
+    }
+    else
+      try
+      {
+        std::get< FieldNumber >( Values )
+          = TheValue->template get< typename Field::Type >();
+      }
+      catch( const JSON::exception & TheError )
+      {
+        Problems << " The field \"" << Field::Name << "\" has the wrong type: "
+                 << TheError.what();
+      }
+  }
+
+  template< std::size_t... FieldNumbers >
+  void DecodeAll( const JSON & TheMessage, std::ostringstream & Problems,
+                  std::index_sequence< FieldNumbers... > )
+  {
+    ( Decode< Fields, FieldNumbers >( TheMessage, Problems ), ... );
+  }
+
+  // --------------------------------------------------------------------------
+  // Access
+  // --------------------------------------------------------------------------
+  //
+  // The value of a mandatory field is returned directly. Reading an optional
+  // field that is not present throws a bad optional access exception, and the
+  // presence of an optional field should therefore be tested first, or the
+  // value should be read with a default value.
+
+public:
+
+  template< const std::string_view & Key >
+  const auto & Get( void ) const
+  {
+    static_assert( FieldIndex< Key > < sizeof...( Fields ),
+                   "The key is not a field of the message view" );
+
+    return std::get< FieldIndex< Key > >( Values ).value();
+  }
+
+  template< const std::string_view & Key >
+  bool Has( void ) const
+  {
+    static_assert( FieldIndex< Key > < sizeof...( Fields ),
+                   "The key is not a field of the message view" );
+
+    return std::get< FieldIndex< Key > >( Values ).has_value();
+  }
+
+  template< const std::string_view & Key, typename DefaultType >
+  auto Value( DefaultType && DefaultValue ) const
+  {
+    static_assert( FieldIndex< Key > < sizeof...( Fields ),
+                   "The key is not a field of the message view" );
+
+    return std::get< FieldIndex< Key > >( Values ).value_or(
+      std::forward< DefaultType >( DefaultValue ) );
+  }
+
+  // A field can be changed or removed when the message is changed after the
+  // view has been decoded so that the view need not be decoded again.
+
+  template< const std::string_view & Key, typename ValueType >
+  void Set( ValueType && TheValue )
+  {
+    static_assert( FieldIndex< Key > < sizeof...( Fields ),
+                   "The key is not a field of the message view" );
+
+    std::get< FieldIndex< Key > >( Values )
+      = std::forward< ValueType >( TheValue );
+  }
+
+  template< const std::string_view & Key >
+  void Erase( void )
+  {
+    static_assert( FieldIndex< Key > < sizeof...( Fields ),
+                   "The key is not a field of the message view" );
+
+    std::get< FieldIndex< Key > >( Values ).reset();
+  }
+
+  // --------------------------------------------------------------------------
+  // Constructor
+  // --------------------------------------------------------------------------
+  //
+  // The view is constructed from the JSON message, and an invalid argument
+  // exception is thrown if the message does not match the fields of the view.
+
+  MessageView( const JSON & TheMessage,
+               const std::source_location & Location
+                                          = std::source_location::current() )
+  : Values()
+  {
+    std::ostringstream Problems;
+
+    DecodeAll( TheMessage, Problems,
+               std::index_sequence_for< Fields... >() );
+
+    if( !Problems.str().empty() )
+    {
+      std::ostringstream ErrorMessage;
+
+      ErrorMessage << "[" << Location.file_name() << " at line "
+                   << Location.line()
+                   << " in function " << Location.function_name() <<"] "
+                   << "The message is invalid:" << Problems.str()
+                   << std::endl << TheMessage.dump(2);
+
+      throw std::invalid_argument( ErrorMessage.str() );
+    }
+  }
+
+  MessageView( const MessageView & Other ) = default;
+  ~MessageView() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_MESSAGE_VIEW
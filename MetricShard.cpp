@@ -0,0 +1,234 @@
+/*==============================================================================
+Metric Shard
+
+This file implements the methods of the Metric Shard actor receiving the metric
+predictions of a subset of the application's metrics. Please see the header
+file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <ranges>                                  // Container ranges
+#include <algorithm>                               // Algorithms
+#include <vector>                                  // Removed metrics
+#include <charconv>                                // Fast number decoding
+#include <system_error>                            // Conversion errors
+
+#include "proton/message.hpp"                      // AMQ message body
+#include "proton/value.hpp"                        // Reading the body text
+
+#include "Utility/ConsolePrint.hpp"                // For logging
+#include "Communication/AMQ/AMQEndpoint.hpp"       // For Topic subscriptions
+
+#include "MetricShard.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Metric value message decoding
+// --------------------------------------------------------------------------
+//
+// The key is searched for with the standard find function, and it must be 
+// enclosed in unescaped quotes and followed by a colon to be accepted as a 
+// key. Other occurrences of the key string, for instance in a string value, 
+// are skipped. The scan continues after the first key found, and the text is
+// ambiguous if the key is found again.
+
+std::string_view MetricShard::MetricValueUpdate::FieldText( 
+  std::string_view TheMessage, std::string_view TheKey )
+{
+  constexpr std::string_view WhiteSpace = " \t\r\n";
+  std::string_view TheValue;
+
+  for( std::size_t Position = TheMessage.find( TheKey ); 
+       Position != std::string_view::npos; 
+       Position = TheMessage.find( TheKey, Position + 1 ) )
+  {
+    std::size_t End = Position + TheKey.size();
+
+    if( ( Position > 0 ) && ( TheMessage[ Position - 1 ] == '"' ) && 
+        ( ( Position == 1 ) || ( TheMessage[ Position - 2 ] != '\\' ) ) &&
+        ( End < TheMessage.size() ) && ( TheMessage[ End ] == '"' ) )
+    {
+      std::size_t Colon = TheMessage.find_first_not_of( WhiteSpace, End + 1 );
+
+      if( ( Colon != std::string_view::npos ) && ( TheMessage[ Colon ] == ':' ) )
+      {
+        std::size_t Value = TheMessage.find_first_not_of( WhiteSpace, 
+                                                          Colon + 1 );
+
+        if( Value == std::string_view::npos ) continue;
+
+        if( TheValue.empty() )
+          TheValue = TheMessage.substr( Value );
+        else
+          return std::string_view();
+      }
+    }
+  }
+
+  return TheValue;
+}
+
+// The message is initialised from the text of the message body. The scan
+// can only tell that a key is a top level key of the message if the message
+// has no nested objects, and the text must therefore contain only the brace
+// opening the message. The numbers are decoded with the locale independent 
+// character conversion functions, and the number must end where the JSON 
+// value ends. If any of this fails, the message is parsed as a normal JSON 
+// message.
+
+bool MetricShard::MetricValueUpdate::Initialize( 
+  const Theron::AMQ::Message::PayloadType & ThePayload ) noexcept
+{
+  try
+  {
+    const std::string & TheBody 
+                      = proton::get< std::string >( ThePayload->body() );
+    std::string_view TheMessage( TheBody ),
+                     ValueText( FieldText( TheMessage, Keys::ValueLabel ) ),
+                     TimeText ( FieldText( TheMessage, Keys::TimePoint  ) );
+
+    auto EndsValue = []( const char * Position, std::string_view TheText ){
+      return ( Position != TheText.data() ) && 
+        ( ( Position == TheText.data() + TheText.size() ) ||
+          ( std::string_view( " \t\r\n,}" ).find( *Position ) 
+            != std::string_view::npos ) );
+    };
+
+    if( !ValueText.empty() && !TimeText.empty() &&
+        ( std::ranges::count( TheMessage, '{' ) == 1 ) )
+    {
+      auto [ ValueEnd, ValueError ] = std::from_chars( ValueText.data(), 
+        ValueText.data() + ValueText.size(), NumericValue );
+      auto [ TimeEnd, TimeError ] = std::from_chars( TimeText.data(), 
+        TimeText.data() + TimeText.size(), PredictionTime );
+
+      Decoded = ( ValueError == std::errc() ) && ( TimeError == std::errc() ) &&
+                EndsValue( ValueEnd, ValueText ) && EndsValue( TimeEnd, TimeText );
+    }
+    else
+      Decoded = false;
+  }
+  catch( ... )
+  {
+    Decoded = false;
+  }
+
+  if( Decoded ) 
+    return true;
+  else
+    return JSONWildcardMessage::Initialize( ThePayload );
+}
+
+// --------------------------------------------------------------------------
+// Metric values
+// --------------------------------------------------------------------------
+//
+// The metric name is the remainder of the topic after the root string of the
+// prediction topics. Values for metrics not owned by the shard are ignored as
+// they may arrive after the metric has been moved or removed. The values are
+// not logged since the purpose of the shard is to keep up with the rate of
+// metric predictions.
+
+void MetricShard::UpdateMetricValue( const MetricValueUpdate & TheMetricValue,
+                                     const Address TheMetricTopic )
+{
+  Theron::AMQ::TopicName TheTopic
+          = TheMetricTopic.AsString().erase( 0,
+                           MetricValueUpdate::MetricValueRootString.size() );
+
+  auto TheRecord = MetricValues.find( TheTopic );
+
+  if( TheRecord != MetricValues.end() )
+  {
+    TheRecord->second = TheMetricValue.Value();
+    ValidityTime      = std::max( ValidityTime, TheMetricValue.TimePoint() );
+  }
+}
+
+// --------------------------------------------------------------------------
+// Metric assignment
+// --------------------------------------------------------------------------
+//
+// The metrics no longer owned are removed and their subscriptions closed
+// before the new metrics are added with subscriptions.
+
+void MetricShard::AssignMetrics( const MetricAssignment & TheAssignment,
+                                 const Address TheMetricUpdater )
+{
+  std::vector< std::string > RemovedMetrics;
+
+  for( const auto & TheMetric : std::views::keys( MetricValues ) )
+    if( !TheAssignment.Metrics.contains( TheMetric ) )
+      RemovedMetrics.push_back( TheMetric );
+
+  for( const auto & TheMetric : RemovedMetrics )
+  {
+    MetricValues.erase( TheMetric );
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+      std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ),
+      GetSessionLayerAddress() );
+  }
+
+  for( const auto & TheMetric : TheAssignment.Metrics )
+    if( MetricValues.try_emplace( TheMetric, JSON() ).second )
+      Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+        Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+        std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ),
+        GetSessionLayerAddress() );
+}
+
+// --------------------------------------------------------------------------
+// Snapshots
+// --------------------------------------------------------------------------
+//
+// The snapshot is returned to the Metric Updater together with the number of
+// metrics that have not yet received a value.
+
+void MetricShard::TakeSnapshot( const SnapshotRequest & TheRequest,
+                                const Address TheMetricUpdater )
+{
+  unsigned int UnsetMetrics
+    = std::ranges::count_if( std::views::values( MetricValues ),
+      [](const auto & MetricValue){ return MetricValue.is_null(); } );
+
+  Send( Snapshot( TheRequest.Sequence, MetricValues, UnsetMetrics,
+                  ValidityTime ), TheMetricUpdater );
+}
+
+// --------------------------------------------------------------------------
+// Constructor and destructor
+// --------------------------------------------------------------------------
+//
+
+MetricShard::MetricShard( const std::string & ShardName )
+: Actor( ShardName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() ),
+  NetworkingActor( Actor::GetAddress().AsString() ),
+  MetricValues(), ValidityTime( 0 )
+{
+  RegisterHandler( this, &MetricShard::UpdateMetricValue );
+  RegisterHandler( this, &MetricShard::AssignMetrics     );
+  RegisterHandler( this, &MetricShard::TakeSnapshot      );
+}
+
+MetricShard::~MetricShard()
+{
+  if( HasNetwork() )
+    std::ranges::for_each( std::views::keys( MetricValues ),
+    [this]( const Theron::AMQ::TopicName & TheMetric ){
+      Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+        Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+        std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ),
+        GetSessionLayerAddress() );
+    });
+}
+
+} // End name space NebulOuS
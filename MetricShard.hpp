@@ -0,0 +1,274 @@
+/*==============================================================================
+Metric Shard
+
+With many metrics and frequent predictions, a single Metric Updater actor
+will spend most of its time parsing metric value messages, and the SLO
+violation messages will wait in its mailbox behind the metric updates. The
+contexts are then built from stale metric values. The metric ingestion can
+therefore be partitioned over a set of Metric Shard actors, each executing on
+its own thread and owning the metrics whose name hashes to the shard.
+
+A shard is told by the Metric Updater which metrics it owns, and it subscribes
+to the predictions of these metrics and records the last value received for
+each of them. When the Metric Updater needs the current application execution
+context, it asks all shards for a snapshot of their metric values and
+assembles the context when all shards have responded. Each shard responds
+with all its metric values at the time of the request so the snapshot of a
+shard is always consistent.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_METRIC_SHARD
+#define NEBULOUS_METRIC_SHARD
+
+// Standard headers
+
+#include <string_view>                          // Constant strings
+#include <string>                               // Standard strings
+#include <set>                                  // Sets of metric names
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// Theron++ files
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+#include "Communication/NetworkingActor.hpp"    // Actor to receive messages
+#include "Communication/PolymorphicMessage.hpp" // The network message type
+
+// AMQ communication files
+
+#include "Communication/AMQ/AMQjson.hpp"         // For JSON metric messages
+#include "Communication/AMQ/AMQEndpoint.hpp"     // AMQ endpoint
+#include "Communication/AMQ/AMQSessionLayer.hpp" // For topic subscriptions
+
+// NebulOuS files
+
+#include "Solver.hpp"                            // Metric value types
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Metric Shard
+
+==============================================================================*/
+
+class MetricShard
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler,
+  virtual public Theron::NetworkingActor<
+    typename Theron::AMQ::Message::PayloadType >
+{
+  // --------------------------------------------------------------------------
+  // Metric values
+  // --------------------------------------------------------------------------
+  //
+  // The metric value message is defined as a topic message where the message
+  // identifier is the root of the metric value topic name string. This is
+  // identical to a wildcard operation matching all topics whose name start
+  // with this string. The message is also used by the Metric Updater when
+  // the metrics are not sharded.
+
+public:
+
+  class MetricValueUpdate
+  : public Theron::AMQ::JSONWildcardMessage
+  {
+  public:
+
+    // The metric value messages will be published on different topics and to
+    // check if an inbound message is from a metric value topic, it is
+    // necessary to test against the base string for the metric value topics
+    // according to the Wiki-page describing the Type II message:
+    // https://openproject.nebulouscloud.eu/projects/nebulous-collaboration-hub/wiki/monitoringdata-interface#type-ii-messages-predicted-monitoring-metrics
+
+    static constexpr std::string_view MetricValueRootString
+                      = "eu.nebulouscloud.monitoring.predicted.";
+
+    // Only two of the fields in this message will be looked up and stored
+    // in the current application context map.
+
+    struct Keys
+    {
+      static constexpr std::string_view
+                ValueLabel = "metricValue",
+                TimePoint  = "predictionTime";
+    };
+
+    // Only the two fields above are used from the message, and there is no
+    // need to build the full JSON object for every metric prediction. The 
+    // received message text is therefore scanned for the two fields, and 
+    // their values are decoded directly. The scan uses the standard string 
+    // search functions that are vectorised by the standard library. The 
+    // full JSON object is only parsed if the message does not have the 
+    // expected form, for instance if the metric value is not a number.
+
+  private:
+
+    bool                  Decoded;
+    double                NumericValue;
+    Solver::TimePointType PredictionTime;
+
+    // The scan looks for the quoted key followed by a colon, and returns 
+    // the text after the colon with leading white space removed. An empty 
+    // string is returned if the key is not found, or if it is found more 
+    // than once so that the scan cannot tell which value is the right one.
+
+    static std::string_view FieldText( std::string_view TheMessage, 
+                                       std::string_view TheKey );
+
+  protected:
+
+    virtual bool Initialize( 
+      const Theron::AMQ::Message::PayloadType & ThePayload ) noexcept override;
+
+    // The values are read with access functions that use the decoded values 
+    // if the fast scan succeeded, and the JSON object otherwise.
+
+  public:
+
+    JSON Value( void ) const
+    {
+      if( Decoded ) return JSON( NumericValue );
+      else          return at( Keys::ValueLabel );
+    }
+
+    Solver::TimePointType TimePoint( void ) const
+    {
+      if( Decoded ) return PredictionTime;
+      else          return at( Keys::TimePoint ).get< Solver::TimePointType >();
+    }
+
+    MetricValueUpdate( void )
+    : JSONWildcardMessage( std::string( MetricValueRootString ) ),
+      Decoded( false ), NumericValue( 0.0 ), PredictionTime( 0 )
+    {}
+
+    MetricValueUpdate( const MetricValueUpdate & Other )
+    : JSONWildcardMessage( Other ),
+      Decoded( Other.Decoded ), NumericValue( Other.NumericValue ),
+      PredictionTime( Other.PredictionTime )
+    {}
+
+    virtual ~MetricValueUpdate() = default;
+  };
+
+  // The shard keeps the last value received for each of its metrics, and the
+  // largest prediction time seen for any of them.
+
+private:
+
+  Solver::MetricValueType MetricValues;
+  Solver::TimePointType   ValidityTime;
+
+  void UpdateMetricValue( const MetricValueUpdate & TheMetricValue,
+                          const Address TheMetricTopic );
+
+  // --------------------------------------------------------------------------
+  // Metric assignment
+  // --------------------------------------------------------------------------
+  //
+  // The Metric Updater sends the set of metrics owned by the shard whenever
+  // the metrics of the application change. The shard will subscribe to the
+  // metrics that are new and close the subscriptions of the metrics no longer
+  // owned by the shard. The values of the metrics kept are retained.
+
+public:
+
+  class MetricAssignment
+  {
+  public:
+
+    const std::set< std::string > Metrics;
+
+    MetricAssignment( const std::set< std::string > & TheMetrics )
+    : Metrics( TheMetrics )
+    {}
+
+    MetricAssignment( const MetricAssignment & Other ) = default;
+    ~MetricAssignment() = default;
+  };
+
+private:
+
+  void AssignMetrics( const MetricAssignment & TheAssignment,
+                      const Address TheMetricUpdater );
+
+  // --------------------------------------------------------------------------
+  // Snapshots
+  // --------------------------------------------------------------------------
+  //
+  // The request for a snapshot carries a sequence number so that the Metric
+  // Updater can discard late responses to an earlier request.
+
+public:
+
+  class SnapshotRequest
+  {
+  public:
+
+    const unsigned long int Sequence;
+
+    SnapshotRequest( unsigned long int TheSequence )
+    : Sequence( TheSequence )
+    {}
+
+    SnapshotRequest( const SnapshotRequest & Other ) = default;
+    ~SnapshotRequest() = default;
+  };
+
+  // The response contains the metric values of the shard, the number of
+  // metrics owned by the shard that have not yet received any value, and the
+  // validity time of the shard's values.
+
+  class Snapshot
+  {
+  public:
+
+    const unsigned long int       Sequence;
+    const Solver::MetricValueType MetricValues;
+    const unsigned int            UnsetMetrics;
+    const Solver::TimePointType   ValidityTime;
+
+    Snapshot( unsigned long int TheSequence,
+              const Solver::MetricValueType & TheValues,
+              unsigned int NumberOfUnsetMetrics,
+              Solver::TimePointType TheValidityTime )
+    : Sequence( TheSequence ), MetricValues( TheValues ),
+      UnsetMetrics( NumberOfUnsetMetrics ), ValidityTime( TheValidityTime )
+    {}
+
+    Snapshot( const Snapshot & Other ) = default;
+    ~Snapshot() = default;
+  };
+
+private:
+
+  void TakeSnapshot( const SnapshotRequest & TheRequest,
+                     const Address TheMetricUpdater );
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The shard only needs a name, and it will receive its metrics from the
+  // Metric Updater. The destructor closes the subscriptions of the metrics
+  // owned by the shard.
+
+public:
+
+  MetricShard( const std::string & ShardName );
+  MetricShard( const MetricShard & Other ) = delete;
+
+  virtual ~MetricShard();
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_METRIC_SHARD
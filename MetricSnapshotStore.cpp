@@ -0,0 +1,133 @@
+/*==============================================================================
+Metric Snapshot Store
+
+This file implements the versioned store of metric value snapshots shared by
+the Metric Updater and the solvers. Please see the header file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <source_location>                         // Informative errors
+#include <sstream>                                 // To format error messages
+#include <stdexcept>                               // Standard exceptions
+#include <utility>                                 // Moving values
+
+#include "MetricSnapshotStore.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Writing snapshots
+// --------------------------------------------------------------------------
+//
+// Since there is only one writer, the next version is the current version
+// plus one. The snapshot is stored in its slot before the current version is
+// updated so that a reader seeing the new version will also find the
+// snapshot.
+
+std::uint64_t MetricSnapshotStore::Publish(
+  Solver::MetricValueType TheValues, Solver::TimePointType TheValidityTime )
+{
+  std::uint64_t NewVersion
+                = CurrentVersion.load( std::memory_order_relaxed ) + 1;
+
+  Ring[ NewVersion % RingSize ].store(
+    std::make_shared< const Snapshot >( Snapshot{ NewVersion,
+      TheValidityTime, std::move( TheValues ) } ),
+    std::memory_order_release );
+
+  CurrentVersion.store( NewVersion, std::memory_order_release );
+
+  return NewVersion;
+}
+
+// --------------------------------------------------------------------------
+// Reading snapshots
+// --------------------------------------------------------------------------
+//
+// The snapshot found in the slot of a version may be of a newer version if
+// the slot has been reused, and the version of the snapshot must therefore
+// be checked.
+
+MetricSnapshotStore::SnapshotPointer
+MetricSnapshotStore::Find( std::uint64_t TheVersion ) const
+{
+  if( TheVersion == 0 ) return SnapshotPointer();
+
+  SnapshotPointer TheSnapshot
+    = Ring[ TheVersion % RingSize ].load( std::memory_order_acquire );
+
+  if( TheSnapshot && ( TheSnapshot->Version == TheVersion ) )
+    return TheSnapshot;
+  else
+    return SnapshotPointer();
+}
+
+MetricSnapshotStore::SnapshotPointer MetricSnapshotStore::Latest( void ) const
+{
+  return Find( CurrentVersion.load( std::memory_order_acquire ) );
+}
+
+// The snapshot referenced by a context is looked up by the version in the
+// context.
+
+MetricSnapshotStore::SnapshotPointer MetricSnapshotStore::Referenced(
+  const Solver::ApplicationExecutionContext::View & TheContext ) const
+{
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+
+  SnapshotPointer TheSnapshot;
+
+  if( TheContext.Has< Keys::SnapshotVersion >() )
+    TheSnapshot = Find( TheContext.Get< Keys::SnapshotVersion >() );
+
+  if( !TheSnapshot )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The metric snapshot "
+                 << TheContext.Value< Keys::SnapshotVersion >( 0 )
+                 << " referenced by the context is not available";
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+
+  return TheSnapshot;
+}
+
+// The metric values given in the context take precedence over the snapshot.
+
+bool MetricSnapshotStore::ReferencesSnapshot(
+  const Solver::ApplicationExecutionContext::View & TheContext )
+{
+  using Keys = Solver::ApplicationExecutionContext::Keys;
+
+  return TheContext.Has< Keys::SnapshotVersion >() &&
+        !TheContext.Has< Keys::ExecutionContext >();
+}
+
+// --------------------------------------------------------------------------
+// Constructor and the shared store
+// --------------------------------------------------------------------------
+//
+
+MetricSnapshotStore::MetricSnapshotStore( void )
+: Ring(), CurrentVersion( 0 )
+{}
+
+MetricSnapshotStore & MetricSnapshotStore::Shared( void )
+{
+  static MetricSnapshotStore TheStore;
+
+  return TheStore;
+}
+
+}      // namespace NebulOuS
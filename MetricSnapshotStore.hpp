@@ -0,0 +1,129 @@
+/*==============================================================================
+Metric Snapshot Store
+
+An application execution context built by the Metric Updater is a copy of all
+the current metric values, and this copy is made again when the context is
+queued by the Solver Manager, and once more when the solver reads the values
+from the context message. The Metric Snapshot Store avoids these copies for
+contexts built inside the Solver Component: The Metric Updater publishes the
+metric values as an immutable, versioned snapshot, and the context sent to
+the Solver Manager carries only the version of the snapshot. The solver reads
+the metric values directly from the snapshot at solve time.
+
+The store follows the Read-Copy-Update (RCU) pattern: A snapshot is never
+changed after it has been published, and a new set of metric values is
+published as a new snapshot. The snapshots are kept in a ring of atomic shared
+pointers indexed by the version number. A reader atomically loads the shared
+pointer of the version it needs, and the snapshot stays alive for as long as
+the reader holds the pointer even if the slot in the ring is reused by the
+writer for a newer version. There is only one writer, the Metric Updater, but
+there may be many concurrent readers.
+
+Note that the atomic shared pointers are not lock-free with the GNU standard
+library: A load or store takes a short spin lock on the slot while the
+reference count is updated. The critical sections are only a few instructions
+long, and they are per slot, so readers of different versions never contend,
+and the writer only contends with readers of the slot it reuses.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_METRIC_SNAPSHOT_STORE
+#define NEBULOUS_METRIC_SNAPSHOT_STORE
+
+// Standard headers
+
+#include <array>                                // The ring of snapshots
+#include <atomic>                               // Atomic pointers
+#include <memory>                               // Shared pointers
+#include <cstdint>                              // Version numbers
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Metric value types
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Metric Snapshot Store
+
+==============================================================================*/
+
+class MetricSnapshotStore
+{
+public:
+
+  // A snapshot holds the metric values, the time point for which the values
+  // are valid, and the version number of the snapshot.
+
+  struct Snapshot
+  {
+    const std::uint64_t           Version;
+    const Solver::TimePointType   ValidityTime;
+    const Solver::MetricValueType MetricValues;
+  };
+
+  using SnapshotPointer = std::shared_ptr< const Snapshot >;
+
+  // The number of snapshots kept in the ring limits how far back in time a
+  // context can refer to a snapshot. It should be larger than the number of
+  // contexts that can be waiting in the Solver Manager's queue.
+
+  static constexpr std::size_t RingSize = 64;
+
+private:
+
+  std::array< std::atomic< SnapshotPointer >, RingSize > Ring;
+  std::atomic< std::uint64_t > CurrentVersion;
+
+  // --------------------------------------------------------------------------
+  // Interface
+  // --------------------------------------------------------------------------
+  //
+  // The writer publishes the metric values as a new snapshot and gets the
+  // version of the snapshot back. The version numbers start from one, and
+  // version zero is used to indicate that there is no snapshot.
+
+public:
+
+  std::uint64_t Publish( Solver::MetricValueType TheValues,
+                         Solver::TimePointType TheValidityTime );
+
+  // The readers can look up the latest snapshot or a snapshot by its version.
+  // An empty pointer is returned if the version is not, or no longer, in the
+  // store.
+
+  SnapshotPointer Latest( void ) const;
+  SnapshotPointer Find( std::uint64_t TheVersion ) const;
+
+  // The snapshot referenced by an application execution context is returned
+  // by a convenience function that throws an invalid argument exception if
+  // the context does not reference a snapshot or if the snapshot has been
+  // overwritten. The context is read through its view.
+
+  SnapshotPointer Referenced(
+    const Solver::ApplicationExecutionContext::View & TheContext ) const;
+
+  // A context refers to a snapshot if it has a snapshot version and no 
+  // metric values of its own.
+
+  static bool ReferencesSnapshot(
+    const Solver::ApplicationExecutionContext::View & TheContext );
+
+  // The Metric Updater and the solvers are running in the same process, and
+  // there is only one store shared by all of them.
+
+  static MetricSnapshotStore & Shared( void );
+
+  // The store can only be constructed empty and it cannot be copied.
+
+  MetricSnapshotStore( void );
+  MetricSnapshotStore( const MetricSnapshotStore & Other ) = delete;
+  ~MetricSnapshotStore() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_METRIC_SNAPSHOT_STORE
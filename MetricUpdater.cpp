@@ -17,11 +17,16 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <iterator>                                // Iterator support
 #include <ranges>                                  // Container ranges
 #include <algorithm>                               // Algorithms
+#include <set>                                     // Sets of metric names
+#include <cmath>                                   // Tolerance tests
+#include <functional>                              // Hashing metric names
+#include <vector>                                  // Metrics per shard
 
 #include "Utility/ConsolePrint.hpp"                // For logging
 #include "Communication/AMQ/AMQEndpoint.hpp"       // For Topic subscriptions
 
 #include "MetricUpdater.hpp"
+#include "MetricSnapshotStore.hpp"
 
 namespace NebulOuS
 {
@@ -33,9 +38,9 @@ namespace NebulOuS
 // The Optimiser controller defines the metric names used in the optimisatoin 
 // model, and the metric subscription will subscribe to these. It is allowed 
 // that the metric list may change during run-time, and therefore the message
-// hadler will make subscriptions for new metrics and remove subscriptions for
-// metrics that are not included in the list, but currently having 
-// subscriptions. 
+// hadler will record the new metric list and make subscriptions for new 
+// metrics and remove subscriptions for metrics that are not included in the 
+// list, but currently having subscriptions. 
 
 void MetricUpdater::AddMetricSubscription( 
      const MetricTopic & MetricDefinitions, const Address OptimiserController )
@@ -44,58 +49,12 @@ void MetricUpdater::AddMetricSubscription(
 
   if( TheMetrics.is_array() )
   {
-    // The first step is to try inserting the metrics into the metric value 
-    // map and if this is successful, a subscription is created for the 
-    // publisherof this metric value. The metric names are recorded since 
-    // some of them may correspond to known metrics, some of them may 
-    // correspond to metrics that are new.
-
-    std::set< std::string > TheMetricNames;
+    MetricList.clear();
 
     for (auto & MetricRecord : TheMetrics )
-    {
-      auto [ MetricRecordPointer, MetricAdded ] = MetricValues.try_emplace( 
-             MetricRecord.get<std::string>(), JSON() );
-
-        TheMetricNames.insert( MetricRecordPointer->first );
-
-        // If a new metric was added, a subscription will be set up for this 
-        // new metric, and the flag indicating that values have been received 
-        // for all metrics will be reset.
-
-      if( MetricAdded )
-        Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
-          Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
-          std::string( MetricValueUpdate::MetricValueRootString ) 
-                       + MetricRecordPointer->first ), 
-          GetSessionLayerAddress() );
-    }
-
-    // There could be some metric value records that were defined by the
-    // previous metrics defined, but missing from the new metric set. If 
-    // this is the case, the metric value records for the missing metrics
-    // should be unsubcribed and their metric records removed.
-
-    for( const auto & TheMetric : std::views::keys( MetricValues ) )
-      if( !TheMetricNames.contains( TheMetric ) )
-      {
-        Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
-          Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
-          std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ), 
-          GetSessionLayerAddress() );
-
-        MetricValues.erase( TheMetric );
-      }
+      MetricList.insert( MetricRecord.get<std::string>() );
 
-    // Finally the number of metrics that does not yet have a value is counted
-    // to ensure that these must be received before the application context 
-    // can be forwarded to the solver manager.
-
-    if( MetricValues.empty() )
-      UnsetMetrics = 1;
-    else
-      UnsetMetrics = std::ranges::count_if( std::views::values( MetricValues ), 
-      [](const auto & MetricValue){ return MetricValue.is_null(); }  );
+    SynchroniseMetrics();
   }
   else
   {
@@ -117,6 +76,123 @@ void MetricUpdater::AddMetricSubscription(
          << MetricDefinitions.dump(2) << std::endl;
 }
 
+// The metrics tracked are the metrics of the metric list that are also used
+// as parameters by the model, or all metrics of the metric list if the model
+// parameters are not yet known. 
+
+void MetricUpdater::SynchroniseMetrics( void )
+{
+  std::set< std::string > UsedMetrics, NewMetrics, RemovedMetrics;
+
+  if( ModelParameterNames.empty() )
+    UsedMetrics = MetricList;
+  else
+    std::ranges::set_intersection( MetricList, ModelParameterNames, 
+      std::inserter( UsedMetrics, UsedMetrics.end() ) );
+
+  // The first step is to try inserting the used metrics into the metric value
+  // map and if this is successful, the metric is recorded as a new metric 
+  // to subscribe to. 
+
+  for( const auto & TheMetric : UsedMetrics )
+    if( MetricValues.try_emplace( TheMetric, JSON() ).second )
+      NewMetrics.insert( TheMetric );
+
+  // There could be some metric value records that were used before, but that
+  // are no longer in the metric list or used by the model. If this is the 
+  // case, the metric value records for these metrics should be unsubcribed 
+  // and their metric records removed.
+
+  for( const auto & TheMetric : std::views::keys( MetricValues ) )
+    if( !UsedMetrics.contains( TheMetric ) )
+      RemovedMetrics.insert( TheMetric );
+
+  for( const auto & TheMetric : RemovedMetrics )
+    MetricValues.erase( TheMetric );
+
+  UpdateSubscriptions( NewMetrics, RemovedMetrics );
+
+  // Finally the number of metrics that does not yet have a value is counted
+  // to ensure that these must be received before the application context 
+  // can be forwarded to the solver manager.
+
+  if( MetricValues.empty() )
+  {
+    UnsetMetrics = AwaitingMetrics() ? 1 : 0;
+
+    if( UnsetMetrics == 0 )
+    {
+      Theron::ConsoleOutput Output;
+      Output << "Metric Updater: The model uses none of the metrics of the "
+             << "metric list and the contexts have no metric values" 
+             << std::endl;
+    }
+  }
+  else
+    UnsetMetrics = std::ranges::count_if( std::views::values( MetricValues ), 
+    [](const auto & MetricValue){ return MetricValue.is_null(); }  );
+
+  // The metrics of the metric list not used by the model are optional and 
+  // they are reported for information.
+
+  if( UsedMetrics.size() < MetricList.size() )
+  {
+    Theron::ConsoleOutput Output;
+    Output << "Metrics not used by the model and not tracked: ";
+
+    for( const auto & TheMetric : MetricList )
+      if( !UsedMetrics.contains( TheMetric ) )
+        Output << TheMetric << " ";
+
+    Output << std::endl;
+  }
+}
+
+// The model parameters are published by the solvers when the model has been
+// defined, and the set of used metrics is updated accordingly.
+
+void MetricUpdater::ModelParametersHandler( 
+     const Solver::ModelParameters & TheParameters, 
+     const Address TheParameterTopic )
+{
+  ModelParameterNames.clear();
+
+  for( const auto & TheParameter : 
+       TheParameters.at( Solver::ModelParameters::Keys::Parameters ) )
+    ModelParameterNames.insert( TheParameter.get< std::string >() );
+
+  SynchroniseMetrics();
+}
+
+// The subscriptions are changed in one pass after the new and the removed
+// metrics have been identified. With the wildcard subscription all metric 
+// predictions are already received, and there is nothing to change. If the 
+// metrics are sharded, the subscriptions are made by the shards.
+
+void MetricUpdater::UpdateSubscriptions( 
+     const std::set< std::string > & NewMetrics,
+     const std::set< std::string > & RemovedMetrics )
+{
+  if( !Shards.empty() )
+  {
+    AssignShardMetrics();
+    return;
+  }
+  else if( WildcardSubscription ) return;
+
+  for( const auto & TheMetric : NewMetrics )
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+      std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ), 
+      GetSessionLayerAddress() );
+
+  for( const auto & TheMetric : RemovedMetrics )
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+      std::string( MetricValueUpdate::MetricValueRootString ) + TheMetric ), 
+      GetSessionLayerAddress() );
+}
+
 // The metric update value is received whenever any of subscribed forecasters
 // has a new value for its metric. The format of the message is described in
 // the project wiki page [1], with an example message given as
@@ -149,8 +225,7 @@ void MetricUpdater::UpdateMetricValue(
   Theron::ConsoleOutput Output;
 
   Output << "Metric value received: " << std::endl 
-         << "   Topic: " << TheMetricTopic.AsString() << std::endl
-         << TheMetricValue.dump(2) << std::endl;
+         << "   Topic: " << TheMetricTopic.AsString() << std::endl;
          
   Theron::AMQ::TopicName TheTopic 
           = TheMetricTopic.AsString().erase( 0, 
@@ -158,12 +233,8 @@ void MetricUpdater::UpdateMetricValue(
 
   if( MetricValues.contains( TheTopic ) )
   {
-    MetricValues.at( TheTopic ) 
-      = TheMetricValue.at( MetricValueUpdate::Keys::ValueLabel );
-    
-    ValidityTime = std::max( ValidityTime, 
-      TheMetricValue.at( 
-        MetricValueUpdate::Keys::TimePoint ).get< Solver::TimePointType >() );
+    MetricValues.at( TheTopic ) = TheMetricValue.Value();
+    ValidityTime = std::max( ValidityTime, TheMetricValue.TimePoint() );
 
     if( UnsetMetrics )
       UnsetMetrics = std::ranges::count_if( std::views::values( MetricValues ), 
@@ -178,6 +249,118 @@ void MetricUpdater::UpdateMetricValue(
   }
 }
 
+// --------------------------------------------------------------------------
+// Sharded metric ingestion
+// --------------------------------------------------------------------------
+//
+// The tracked metrics are distributed over the shards by the hash of the 
+// metric name, and every shard is sent its full set of metrics so that it 
+// can remove the metrics it no longer owns.
+
+void MetricUpdater::AssignShardMetrics( void )
+{
+  std::vector< std::set< std::string > > ShardMetrics( Shards.size() );
+
+  for( const auto & TheMetric : std::views::keys( MetricValues ) )
+    ShardMetrics[ std::hash< std::string >{}( TheMetric ) % Shards.size() ]
+      .insert( TheMetric );
+
+  for( const auto & [ TheShard, TheMetrics ] : 
+       std::ranges::views::zip( Shards, ShardMetrics ) )
+    Send( MetricShard::MetricAssignment( TheMetrics ), 
+          TheShard->GetAddress() );
+}
+
+// The snapshots from the shards are merged into the metric value map, and 
+// responses to an earlier request are ignored. When all shards have 
+// responded, the context is forwarded if all metrics have values and the 
+// application is still running.
+
+void MetricUpdater::CollectSnapshot( const MetricShard::Snapshot & TheSnapshot, 
+                                     const Address TheShard )
+{
+  if( ( TheSnapshot.Sequence != SnapshotSequence ) || ( PendingShards == 0 ) ) 
+    return;
+
+  for( const auto & [ TheMetric, TheValue ] : TheSnapshot.MetricValues )
+  {
+    auto TheRecord = MetricValues.find( TheMetric );
+
+    if( TheRecord != MetricValues.end() )
+      TheRecord->second = TheValue;
+  }
+
+  SnapshotUnsetMetrics += TheSnapshot.UnsetMetrics;
+  ValidityTime = std::max( ValidityTime, TheSnapshot.ValidityTime );
+
+  if( --PendingShards == 0 )
+  {
+    UnsetMetrics = AwaitingMetrics() ? 1 : SnapshotUnsetMetrics;
+
+    if( ( ApplicationState == ApplicationLifecycle::State::Running ) && 
+        ( UnsetMetrics == 0 ) )
+      ForwardContext( SnapshotTime );
+    else
+    {
+      Theron::ConsoleOutput Output;
+      Output << "Metric Updater: The snapshot of the metric values could not "
+             << "be used (size: " << MetricValues.size() << "," << " Unset: " 
+             << UnsetMetrics << " Application state: " << ApplicationState
+             << ")" << std::endl;
+    }
+
+    NextSnapshot();
+  }
+}
+
+// A snapshot is requested from all shards for the time point of the SLO 
+// violation, and the timer is armed for the request.
+
+void MetricUpdater::RequestSnapshot( Solver::TimePointType TheTimePoint )
+{
+  SnapshotTime         = TheTimePoint;
+  SnapshotUnsetMetrics = 0;
+  PendingShards        = Shards.size();
+  SnapshotSequence++;
+
+  for( const auto & TheShard : Shards )
+    Send( MetricShard::SnapshotRequest( SnapshotSequence ), 
+          TheShard->GetAddress() );
+
+  Send( Timer::WakeUp( ShardTimeout, SnapshotSequence ), 
+        SnapshotTimer.GetAddress() );
+}
+
+// The timeout of a completed snapshot is ignored. Otherwise the snapshot is
+// abandoned and the responses still to come will be ignored since they have
+// the sequence number of the abandoned request.
+
+void MetricUpdater::SnapshotTimeout( const Timer::Timeout & TheTimeout, 
+                                     const Address TheTimer )
+{
+  if( ( TheTimeout.Tag != SnapshotSequence ) || ( PendingShards == 0 ) )
+    return;
+
+  Theron::ConsoleOutput Output;
+  Output << "Metric Updater: " << PendingShards << " of " << Shards.size() 
+         << " shards did not respond to the snapshot request " 
+         << SnapshotSequence << " and the snapshot is abandoned" << std::endl;
+
+  PendingShards = 0;
+  NextSnapshot();
+}
+
+// The queued violation is only used if the application is still running.
+
+void MetricUpdater::NextSnapshot( void )
+{
+  if( QueuedViolation && 
+      ( ApplicationState == ApplicationLifecycle::State::Running ) )
+    RequestSnapshot( *QueuedViolation );
+
+  QueuedViolation.reset();
+}
+
 // --------------------------------------------------------------------------
 // Application lifcycle
 // --------------------------------------------------------------------------
@@ -233,11 +416,6 @@ MetricUpdater::ApplicationLifecycle::operator State() const
 // message will just be ignored. In order to avoid the scan over all metrics
 // to see if they are set, a boolean flag will be used and set once all metrics
 // have values. Then future scans will be avoided.
-// The message will be ignored if not all metric values have been received 
-// or if there are no metric values defined. In both cases the SLO violation 
-// message will just be ignored. In order to avoid the scan over all metrics
-// to see if they are set, a boolean flag will be used and set once all metrics
-// have values. Then future scans will be avoided.
 
 void MetricUpdater::SLOViolationHandler( 
      const SLOViolation & SeverityMessage, const Address TheSLOTopic )
@@ -246,17 +424,30 @@ void MetricUpdater::SLOViolationHandler(
   Output << "Metric Updater: SLO violation received " << std::endl
          << SeverityMessage.dump(2) << std::endl;
 
-  if(( ApplicationState == ApplicationLifecycle::State::Running ) && 
-     ( UnsetMetrics == 0 ) )
+  // With sharded ingestion the metric values are not known before the 
+  // snapshot has been collected from the shards, and the test for unset 
+  // metrics is then made when all shards have responded.
+
+  if( ( ApplicationState == ApplicationLifecycle::State::Running ) && 
+      !Shards.empty() )
   {
-    Send( Solver::ApplicationExecutionContext(
-      SeverityMessage.at( 
-        MetricValueUpdate::Keys::TimePoint ).get< Solver::TimePointType >(),
-      MetricValues, true
-    ), TheSolverManager );
+    Solver::TimePointType TheTimePoint = SeverityMessage.at( 
+      MetricValueUpdate::Keys::TimePoint ).get< Solver::TimePointType >();
 
-    ApplicationState    = ApplicationLifecycle::State::Deploying;
+    if( PendingShards == 0 )
+      RequestSnapshot( TheTimePoint );
+    else
+    {
+      QueuedViolation = TheTimePoint;
+
+      Output << "... queued while the metric snapshot is collected" 
+             << std::endl;
+    }
   }
+  else if(( ApplicationState == ApplicationLifecycle::State::Running ) && 
+          ( UnsetMetrics == 0 ) )
+    ForwardContext( SeverityMessage.at( 
+      MetricValueUpdate::Keys::TimePoint ).get< Solver::TimePointType >() );
   else
   {
     Output << "... failed to forward the application execution context (size: " 
@@ -273,6 +464,140 @@ void MetricUpdater::SLOViolationHandler(
   }
 }
 
+// The context is forwarded with the current metric values unless these are 
+// unchanged relative to the last solved context.
+
+void MetricUpdater::ForwardContext( Solver::TimePointType TheTimePoint )
+{
+  Theron::ConsoleOutput Output;
+
+  // If the metric values are within the tolerances of the last solved 
+  // context, the previous solution is re-published for the new time point
+  // instead of solving the same problem again.
+
+  if( UnchangedContext( MetricValues ) )
+  {
+    Solver::Solution PreviousSolution( LastSolution );
+
+    PreviousSolution[ Solver::Solution::Keys::TimeStamp ] = TheTimePoint;
+    Send( PreviousSolution, Address( Solver::Solution::AMQTopic ) );
+
+    Output << "... the context is unchanged and the previous solution is "
+           << "re-published" << std::endl;
+  }
+  else
+  {
+    // The metric values are published to the shared snapshot store and the 
+    // context only refers to the snapshot version. The context is identified
+    // by the name of the Metric Updater with the prefix reserved for local 
+    // actors so that other requesters may send delta contexts relative to the
+    // last context sent by the Metric Updater, but cannot replace it.
+
+    Solver::ApplicationExecutionContext TheContext( TheTimePoint, 
+      MetricSnapshotStore::Shared().Publish( MetricValues, ValidityTime ), 
+      true );
+
+    TheContext[ Solver::ApplicationExecutionContext::Keys::ContextID ] 
+      = std::string( Solver::ApplicationExecutionContext::LocalReply ) 
+        + GetAddress().AsString();
+
+    Send( TheContext, TheSolverManager );
+
+    PendingContext = MetricValues;
+    PendingTime    = TheTimePoint;
+  }
+
+  ApplicationState = ApplicationLifecycle::State::Deploying;
+}
+
+// --------------------------------------------------------------------------
+// Unchanged execution contexts
+// --------------------------------------------------------------------------
+//
+// The tolerances are updated for the fields given in the message, and the 
+// absolute and relative tolerances can be set independently.
+
+void MetricUpdater::SetTolerances( const MetricTolerance & TheTolerances, 
+                                   const Address TheSender )
+{
+  auto UpdateTolerance = []( const JSON & TheSetting, Tolerance & TheTolerance ){
+    TheTolerance.Absolute = TheSetting.value( 
+      MetricTolerance::Keys::Absolute, TheTolerance.Absolute );
+    TheTolerance.Relative = TheSetting.value( 
+      MetricTolerance::Keys::Relative, TheTolerance.Relative );
+  };
+
+  if( TheTolerances.contains( MetricTolerance::Keys::DefaultTolerance ) )
+    UpdateTolerance( 
+      TheTolerances.at( MetricTolerance::Keys::DefaultTolerance ), 
+      DefaultTolerance );
+
+  if( TheTolerances.contains( MetricTolerance::Keys::Metrics ) )
+    for( const auto & [ TheMetric, TheSetting ] : 
+         TheTolerances.at( MetricTolerance::Keys::Metrics ).items() )
+    {
+      auto [ TheRecord, Added ] 
+           = MetricTolerances.try_emplace( TheMetric, DefaultTolerance );
+
+      UpdateTolerance( TheSetting, TheRecord->second );
+    }
+
+  Theron::ConsoleOutput Output;
+  Output << "Metric tolerances updated: " << std::endl
+         << TheTolerances.dump(2) << std::endl;
+}
+
+// The solutions are received on the general solution topic, and only the 
+// deployed solution for the pending context sent by this Metric Updater is 
+// recorded. The pending context is then the last solved context.
+
+void MetricUpdater::RecordSolution( const Solver::Solution & TheSolution, 
+                                    const Address TheSolutionTopic )
+{
+  if( !PendingContext.empty() && 
+      TheSolution.value( Solver::Solution::Keys::DeploymentFlag, false ) &&
+      ( TheSolution.at( Solver::Solution::Keys::TimeStamp 
+                      ).get< Solver::TimePointType >() == PendingTime ) )
+  {
+    SolvedContext = std::move( PendingContext );
+    PendingContext.clear();
+    LastSolution  = TheSolution;
+  }
+}
+
+// A context is unchanged if it has the same metrics as the solved context, 
+// and all numerical values are within the tolerances of the solved value. 
+// Values that are not numbers must be identical.
+
+bool MetricUpdater::UnchangedContext( 
+  const Solver::MetricValueType & TheContext ) const
+{
+  if( LastSolution.is_null() || ( TheContext.size() != SolvedContext.size() ) )
+    return false;
+
+  return std::ranges::all_of( TheContext, [this]( const auto & TheMetric ){
+    auto SolvedValue = SolvedContext.find( TheMetric.first );
+
+    if( SolvedValue == SolvedContext.end() ) 
+      return false;
+    else if( TheMetric.second.is_number() && SolvedValue->second.is_number() )
+    {
+      auto TheTolerance = MetricTolerances.find( TheMetric.first );
+      const Tolerance & Limits = ( TheTolerance == MetricTolerances.end() ) 
+                               ? DefaultTolerance : TheTolerance->second;
+
+      double Solved     = SolvedValue->second.template get< double >(),
+             Difference = std::fabs( TheMetric.second.template get< double >()
+                                     - Solved );
+
+      return ( Difference <= Limits.Absolute ) || 
+             ( Difference <= Limits.Relative * std::fabs( Solved ) );
+    }
+    else
+      return TheMetric.second == SolvedValue->second;
+  });
+}
+
 // --------------------------------------------------------------------------
 // Constructor and destructor
 // --------------------------------------------------------------------------
@@ -289,18 +614,43 @@ void MetricUpdater::SLOViolationHandler(
 // must be made.
 
 MetricUpdater::MetricUpdater( const std::string UpdaterName, 
-                              const Address ManagerOfSolvers )
+                              const Address ManagerOfSolvers,
+                              bool UseWildcardSubscription,
+                              unsigned int NumberOfShards )
 : Actor( UpdaterName ),
   StandardFallbackHandler( Actor::GetAddress().AsString() ),
   NetworkingActor( Actor::GetAddress().AsString() ),
   MetricValues(), ValidityTime(0), UnsetMetrics(1),
+  MetricList(), ModelParameterNames(),
+  WildcardSubscription( UseWildcardSubscription && ( NumberOfShards == 0 ) ),
+  Shards(), SnapshotSequence( 0 ), PendingShards( 0 ), 
+  SnapshotUnsetMetrics( 0 ), SnapshotTime( 0 ), QueuedViolation(),
+  SnapshotTimer( UpdaterName + "_Timer" ),
   ApplicationState( ApplicationLifecycle::State::New ),
+  DefaultTolerance{ 0.0, 0.0 }, MetricTolerances(), 
+  PendingContext(), SolvedContext(), PendingTime( 0 ), LastSolution(),
   TheSolverManager( ManagerOfSolvers )
 {
   RegisterHandler( this, &MetricUpdater::AddMetricSubscription );
   RegisterHandler( this, &MetricUpdater::UpdateMetricValue     );
   RegisterHandler( this, &MetricUpdater::LifecycleHandler      );
   RegisterHandler( this, &MetricUpdater::SLOViolationHandler   );
+  RegisterHandler( this, &MetricUpdater::SetTolerances         );
+  RegisterHandler( this, &MetricUpdater::RecordSolution        );
+  RegisterHandler( this, &MetricUpdater::ModelParametersHandler );
+  RegisterHandler( this, &MetricUpdater::CollectSnapshot       );
+  RegisterHandler( this, &MetricUpdater::SnapshotTimeout       );
+
+  // The shards are named after the Metric Updater with a sequence number 
+  // from 1 and up, in the same way as the solvers of the Solver Manager.
+
+  for( unsigned int i = 1; i <= NumberOfShards; i++ )
+  {
+    std::ostringstream TheShardName;
+
+    TheShardName << UpdaterName << "_Shard_" << i;
+    Shards.emplace_back( std::make_unique< MetricShard >( TheShardName.str() ) );
+  }
   
   Send( Theron::AMQ::NetworkLayer::TopicSubscription(
     Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
@@ -316,6 +666,32 @@ MetricUpdater::MetricUpdater( const std::string UpdaterName,
     Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
     SLOViolation::AMQTopic ), 
     GetSessionLayerAddress() ); 
+
+  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+    MetricTolerance::AMQTopic ), 
+    GetSessionLayerAddress() ); 
+
+  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+    Solver::ModelParameters::AMQTopic ), 
+    GetSessionLayerAddress() ); 
+
+  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+    Solver::Solution::AMQTopic ), 
+    GetSessionLayerAddress() ); 
+
+  Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+    Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher,
+    Solver::Solution::AMQTopic ), 
+    GetSessionLayerAddress() ); 
+
+  if( WildcardSubscription )
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+      PredictionWildcard ), 
+      GetSessionLayerAddress() ); 
 }
 
 // The destructor is closing the established subscription if the network is 
@@ -342,14 +718,40 @@ MetricUpdater::~MetricUpdater()
       SLOViolation::AMQTopic ), 
       GetSessionLayerAddress() );  
 
-    std::ranges::for_each( std::views::keys( MetricValues ),
-    [this]( const Theron::AMQ::TopicName & TheMetricTopic ){
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+      MetricTolerance::AMQTopic ), 
+      GetSessionLayerAddress() );  
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+      Solver::ModelParameters::AMQTopic ), 
+      GetSessionLayerAddress() );  
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+      Solver::Solution::AMQTopic ), 
+      GetSessionLayerAddress() );  
+
+    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+      Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher,
+      Solver::Solution::AMQTopic ), 
+      GetSessionLayerAddress() );  
+
+    if( WildcardSubscription )
       Send( Theron::AMQ::NetworkLayer::TopicSubscription(
         Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
-        std::string( MetricValueUpdate::MetricValueRootString ) 
-                     + TheMetricTopic ), 
-        GetSessionLayerAddress() );
-    });
+        PredictionWildcard ), 
+        GetSessionLayerAddress() );  
+    else if( Shards.empty() )
+      std::ranges::for_each( std::views::keys( MetricValues ),
+      [this]( const Theron::AMQ::TopicName & TheMetricTopic ){
+        Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+          Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+          std::string( MetricValueUpdate::MetricValueRootString ) 
+                       + TheMetricTopic ), 
+          GetSessionLayerAddress() );
+      });
   }
 }
 
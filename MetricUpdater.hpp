@@ -43,6 +43,11 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 
 #include <string_view>                          // Constant strings
 #include <unordered_map>                        // To store metric-value maps
+#include <set>                                  // Sets of metric names
+#include <vector>                               // Metric shards
+#include <memory>                               // Smart pointers
+#include <optional>                             // Queued SLO violations
+#include <chrono>                               // Snapshot timeout
 
 // Other packages
 
@@ -65,6 +70,8 @@ using JSON = nlohmann::json;                    // Short form name space
 // NebulOuS files
 
 #include "Solver.hpp"                            // The generic solver base
+#include "MetricShard.hpp"                       // Sharded metric ingestion
+#include "Timer.hpp"                             // Snapshot timeout
 
 namespace NebulOuS 
 {
@@ -130,7 +137,7 @@ private:
   // to send just an array.
 
   class MetricTopic
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -156,11 +163,11 @@ private:
     // Constructors
 
     MetricTopic( void )
-    : JSONTopicMessage( AMQTopic )
+    : TopicMessage( AMQTopic )
     {}
 
     MetricTopic( const MetricTopic & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other )
     {}
 
     virtual ~MetricTopic() = default;
@@ -174,49 +181,61 @@ private:
   void AddMetricSubscription( const MetricTopic & MetricDefinitions, 
                               const Address OptimiserController );
 
-  // --------------------------------------------------------------------------
-  // Metric values
-  // --------------------------------------------------------------------------
-  //
-  // The metric value message is defined as a topic message where the message 
-  // identifier is the root of the metric value topic name string. This is 
-  // identical to a wildcard operation matching all topics whose name start
-  // with this string. 
-  
-  class MetricValueUpdate
-  : public Theron::AMQ::JSONWildcardMessage
+  // The solvers publish the names of the parameters declared by the model 
+  // when the model has been defined. Only the metrics of the metric list that
+  // are also model parameters are tracked, and the other metrics are 
+  // optional. They are not subscribed to, and they are not included in the 
+  // application execution context. All metrics of the metric list are 
+  // tracked if the model parameters are not known.
+
+  std::set< std::string > MetricList, ModelParameterNames;
+
+  void ModelParametersHandler( const Solver::ModelParameters & TheParameters,
+                               const Address TheParameterTopic );
+
+  // The set of tracked metrics is updated when either set changes.
+
+  void SynchroniseMetrics( void );
+
+  // When no metric is tracked, the context cannot be forwarded before both 
+  // the metric list and the model parameters are known. If the model then 
+  // uses none of the metrics of the metric list, there is no metric value to
+  // wait for, and the contexts are forwarded without metric values.
+
+  bool AwaitingMetrics( void ) const
   {
-  public:
+    return MetricValues.empty() && 
+           ( MetricList.empty() || ModelParameterNames.empty() );
+  }
 
-    // The metric value messages will be published on different topics and to 
-    // check if an inbound message is from a metric value topic, it is 
-    // necessary to test against the base string for the metric value topics 
-    // according to the Wiki-page describing the Type II message:
-    // https://openproject.nebulouscloud.eu/projects/nebulous-collaboration-hub/wiki/monitoringdata-interface#type-ii-messages-predicted-monitoring-metrics
+  // With thousands of metrics, there will be thousands of subscriptions to 
+  // set up with the AMQ broker. The Metric Updater can therefore be told to 
+  // use a single wildcard subscription for all predicted metric topics, and 
+  // discard the values of metrics that are not known. The wildcard uses the 
+  // ActiveMQ syntax where '>' matches all topics starting with the root 
+  // string.
 
-    static constexpr std::string_view MetricValueRootString
-                      = "eu.nebulouscloud.monitoring.predicted.";
+  const bool WildcardSubscription;
 
-    // Only two of the fields in this message will be looked up and stored
-    // in the current application context map.
+  static constexpr std::string_view PredictionWildcard
+                   = "eu.nebulouscloud.monitoring.predicted.>";
 
-    struct Keys
-    {
-      static constexpr std::string_view 
-                ValueLabel = "metricValue",
-                TimePoint  = "predictionTime";
-    };
+  // The changes in the metric list are collected and applied in one pass by
+  // a function that subscribes to the new metrics and closes the 
+  // subscriptions of the removed metrics. Nothing is sent to the AMQ broker 
+  // when using the wildcard subscription.
 
-    MetricValueUpdate( void )
-    : JSONWildcardMessage( std::string( MetricValueRootString ) )
-    {}
-    
-    MetricValueUpdate( const MetricValueUpdate & Other )
-    : JSONWildcardMessage( Other )
-    {}
+  void UpdateSubscriptions( const std::set< std::string > & NewMetrics,
+                            const std::set< std::string > & RemovedMetrics );
 
-    virtual ~MetricValueUpdate() = default;
-  };
+  // --------------------------------------------------------------------------
+  // Metric values
+  // --------------------------------------------------------------------------
+  //
+  // The metric value message is defined by the Metric Shard since the metric
+  // values are received by the shards when the metric ingestion is sharded.
+
+  using MetricValueUpdate = MetricShard::MetricValueUpdate;
 
   // The handler function will update the value of the subscribed metric  
   // based on the given topic name. If there is no such metric known, then the
@@ -225,6 +244,60 @@ private:
   void UpdateMetricValue( const MetricValueUpdate & TheMetricValue, 
                           const Address TheMetricTopic );
 
+  // --------------------------------------------------------------------------
+  // Sharded metric ingestion
+  // --------------------------------------------------------------------------
+  //
+  // The metrics can be partitioned over a number of Metric Shards where each
+  // shard owns the metrics whose name hashes to the shard's index. The 
+  // metric value map of the Metric Updater then keeps only the names of the
+  // tracked metrics, and their values are refreshed from the shards when an 
+  // application execution context is needed. There are no shards if the 
+  // metric values are received by the Metric Updater itself.
+
+  std::vector< std::unique_ptr< MetricShard > > Shards;
+
+  // The shards are told about the metrics they own when the tracked metrics
+  // change.
+
+  void AssignShardMetrics( void );
+
+  // The snapshot of the metric values is requested from all shards when an 
+  // SLO violation arrives, and the responses are collected until all shards
+  // have responded. The sequence number identifies the current request. 
+  // The metric values may change while a snapshot is collected, and the SLO
+  // violations arriving in the meantime are therefore coalesced into one 
+  // violation with the time point of the last violation, which starts a new
+  // snapshot when the current snapshot is completed.
+
+  unsigned long int     SnapshotSequence;
+  unsigned int          PendingShards, SnapshotUnsetMetrics;
+  Solver::TimePointType SnapshotTime;
+
+  std::optional< Solver::TimePointType > QueuedViolation;
+
+  void RequestSnapshot( Solver::TimePointType TheTimePoint );
+
+  void CollectSnapshot( const MetricShard::Snapshot & TheSnapshot, 
+                        const Address TheShard );
+
+  // A shard that does not respond would block all later SLO violations, and
+  // the collection is therefore abandoned if all shards have not responded 
+  // within the timeout. No context is forwarded for an abandoned snapshot 
+  // since the values of the missing shards are unknown.
+
+  static constexpr std::chrono::milliseconds ShardTimeout{ 2000 };
+
+  Timer SnapshotTimer;
+
+  void SnapshotTimeout( const Timer::Timeout & TheTimeout, 
+                        const Address TheTimer );
+
+  // When a snapshot is completed or abandoned, the queued violation, if any,
+  // starts the next snapshot.
+
+  void NextSnapshot( void );
+
   // --------------------------------------------------------------------------
   // Application lifecycle
   // --------------------------------------------------------------------------
@@ -235,7 +308,7 @@ private:
   // SLO Violations detected.
 
   class ApplicationLifecycle
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   { 
   public:
 
@@ -297,11 +370,11 @@ private:
     // Constructors and destructor
 
     ApplicationLifecycle( void )
-    : JSONTopicMessage( AMQTopic )
+    : TopicMessage( AMQTopic )
     {}
 
     ApplicationLifecycle( const ApplicationLifecycle & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other )
     {}
 
     virtual ~ApplicationLifecycle() = default;
@@ -346,7 +419,7 @@ private:
   // message will trigger a reconfiguration.
   
   class SLOViolation
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -368,11 +441,11 @@ private:
     // Constructors
 
     SLOViolation( void )
-    : JSONTopicMessage( AMQTopic )
+    : TopicMessage( AMQTopic )
     {}
 
     SLOViolation( const SLOViolation & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other )
     {}
 
     virtual ~SLOViolation() = default;
@@ -385,6 +458,90 @@ private:
   void SLOViolationHandler( const SLOViolation & SeverityMessage, 
                             const Address TheSLOTopic );
 
+  // The context is forwarded to the Solver Manager, or the previous solution
+  // re-published, by a function used both by the SLO violation handler and 
+  // when the snapshot has been collected from the shards.
+
+  void ForwardContext( Solver::TimePointType TheTimePoint );
+
+  // --------------------------------------------------------------------------
+  // Unchanged execution contexts
+  // --------------------------------------------------------------------------
+  //
+  // An SLO violation may be reported even though no metric value has changed
+  // significantly since the last application execution context was solved. 
+  // There is then no need to solve the problem again, and the previous 
+  // solution can be re-published for the new time point. A metric value is 
+  // unchanged if the difference to the solved value is within an absolute 
+  // tolerance or within a tolerance relative to the solved value. The default
+  // tolerances are zero so that only identical values are unchanged. 
+
+  struct Tolerance
+  {
+    double Absolute, Relative;
+  };
+
+  Tolerance DefaultTolerance;
+  std::unordered_map< std::string, Tolerance > MetricTolerances;
+
+  // The tolerances can be set by a message giving the default tolerance and 
+  // the tolerances for individual metrics. Both fields are optional, and the 
+  // tolerance for a metric not given in the message will not be changed.
+  // {
+  //   "Default" : { "Absolute" : 0.0, "Relative" : 0.01 },
+  //   "Metrics" : { 
+  //      "<metric name>" : { "Absolute" : 1.0, "Relative" : 0.0 }, ...
+  //   }
+  // }
+
+  class MetricTolerance
+  : public TopicMessage
+  {
+  public:
+
+    static constexpr std::string_view AMQTopic 
+                     = "eu.nebulouscloud.optimiser.solver.tolerances";
+
+    struct Keys
+    {
+      static constexpr std::string_view 
+        DefaultTolerance = "Default",
+        Metrics          = "Metrics",
+        Absolute         = "Absolute",
+        Relative         = "Relative";
+    };
+
+    MetricTolerance( void )
+    : TopicMessage( AMQTopic )
+    {}
+
+    MetricTolerance( const MetricTolerance & Other )
+    : TopicMessage( Other )
+    {}
+
+    virtual ~MetricTolerance() = default;
+  };
+
+  void SetTolerances( const MetricTolerance & TheTolerances, 
+                      const Address TheSender );
+
+  // The last context sent to the Solver Manager is kept as pending until the 
+  // solution for this context is received on the solution topic. The solved 
+  // context and its solution are then kept for comparison with future 
+  // contexts. 
+
+  Solver::MetricValueType PendingContext, SolvedContext;
+  Solver::TimePointType   PendingTime;
+  JSON                    LastSolution;
+
+  void RecordSolution( const Solver::Solution & TheSolution, 
+                       const Address TheSolutionTopic );
+
+  // The test for an unchanged context requires that the same metrics are 
+  // defined and that all metric values are within their tolerances.
+
+  bool UnchangedContext( const Solver::MetricValueType & TheContext ) const;
+
   // The application execution context (message) will be sent to the
   // Solution Manager actor that will invoke a solver to find the optimal 
   // configuration for this configuration. The Metric Updater must therefore 
@@ -410,7 +567,7 @@ private:
   // the JSON map received.
 
   class ReconfigurationMessage
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   { 
   public:
 
@@ -423,11 +580,11 @@ private:
     // Constructors
 
     ReconfigurationMessage( void )
-    : JSONTopicMessage( AMQTopic )
+    : TopicMessage( AMQTopic )
     {}
 
     ReconfigurationMessage( const ReconfigurationMessage & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other )
     {}
 
     virtual ~ReconfigurationMessage() = default;
@@ -447,12 +604,18 @@ private:
   //
   // The constructor requires the name of the Metric Updater Actor, and the 
   // actor address of the Solution Manager Actor. It registers the handlers
-  // for all the message types
+  // for all the message types. Optionally, it can be told to use the single 
+  // wildcard subscription for all metric predictions, or to partition the 
+  // metric ingestion over a number of shards. The wildcard subscription is 
+  // not used with shards since every shard would then receive all metric 
+  // predictions.
 
 public:
 
   MetricUpdater( const std::string UpdaterName, 
-                 const Address ManagerOfSolvers );
+                 const Address ManagerOfSolvers,
+                 bool UseWildcardSubscription = false,
+                 unsigned int NumberOfShards = 0 );
 
   // The destructor will unsubscribe from the control channels for the 
   // message defining metrics, and the channel for receiving SLO violation
@@ -0,0 +1,487 @@
+/*==============================================================================
+Solution History
+
+This file implements the segment files of the solution history and the
+queries over the stored solution records.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <fstream>                // For payload file I/O
+#include <sstream>                // For formatted errors
+#include <stdexcept>              // Standard exceptions
+#include <system_error>           // Error codes
+#include <source_location>        // For better errors
+#include <cerrno>                 // System error numbers
+#include <cmath>                  // Distances
+#include <algorithm>              // Sorting
+#include <ranges>                 // Range views
+#include <charconv>               // Segment numbers from file names
+#include <map>                    // Sorted distances
+
+#include <fcntl.h>                // Opening the column files
+#include <unistd.h>               // Closing and resizing files
+#include <sys/mman.h>             // Memory mapping
+#include <sys/stat.h>             // File sizes
+
+#include "SolutionHistory.hpp"
+
+namespace NebulOuS
+{
+
+// -----------------------------------------------------------------------------
+// Segment
+// -----------------------------------------------------------------------------
+//
+// The segment constructor opens the column file, and if the file is new, it
+// will be extended to the full size of the header and the columns so that the
+// whole file can be mapped at once. All system errors result in a system error
+// exception.
+
+SolutionHistory::Segment::Segment(
+  const std::filesystem::path & TheColumnFile,
+  const std::filesystem::path & ThePayloadFile, std::size_t Capacity )
+: PayloadFile( ThePayloadFile ), ColumnFile( -1 ), MappedSize( 0 ),
+  MappedColumns( nullptr ), TheHeader( nullptr )
+{
+  auto SystemError = [&]( const std::string & TheOperation,
+                         const std::source_location & Location
+                                          = std::source_location::current() ){
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "Solution history segment " << TheColumnFile
+                 << " failed to " << TheOperation;
+
+    throw std::system_error( errno, std::system_category(),
+                             ErrorMessage.str() );
+  };
+
+  ColumnFile = open( TheColumnFile.c_str(), O_RDWR | O_CREAT, 0644 );
+
+  if( ColumnFile < 0 ) SystemError( "open" );
+
+  struct stat FileStatus;
+
+  if( fstat( ColumnFile, &FileStatus ) < 0 ) SystemError( "get the file size" );
+
+  bool NewSegment = ( FileStatus.st_size == 0 );
+
+  if( NewSegment )
+  {
+    MappedSize = sizeof( Header ) + Capacity * sizeof( std::uint64_t ) *
+                 static_cast< std::size_t >( Column::NumberOfColumns );
+
+    if( ftruncate( ColumnFile, MappedSize ) < 0 ) SystemError( "resize" );
+  }
+  else
+    MappedSize = FileStatus.st_size;
+
+  void * Mapping = mmap( nullptr, MappedSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, ColumnFile, 0 );
+
+  if( Mapping == MAP_FAILED ) SystemError( "map the columns" );
+
+  MappedColumns = static_cast< std::byte * >( Mapping );
+  TheHeader     = reinterpret_cast< Header * >( MappedColumns );
+
+  if( NewSegment )
+    *TheHeader = Header{ SegmentMagic, Capacity, 0 };
+  else if( TheHeader->Magic != SegmentMagic )
+  {
+    errno = EINVAL;
+    SystemError( "validate the segment header" );
+  }
+}
+
+// The destructor unmaps the columns and closes the file. The operating system
+// will write the mapped pages back to the file.
+
+SolutionHistory::Segment::~Segment()
+{
+  if( MappedColumns != nullptr ) munmap( MappedColumns, MappedSize );
+  if( ColumnFile >= 0 ) close( ColumnFile );
+}
+
+// Appending the payload to the payload file gives the offset of the payload
+// before the column values are set. The count is only updated when all the
+// values of the record have been written.
+
+void SolutionHistory::Segment::Append(
+  Solver::TimePointType TheTime, double TheObjectiveValue,
+  std::uint64_t TheSolveTime, std::uint64_t TheModelVersion,
+  const std::vector< std::uint8_t > & ThePayload )
+{
+  std::ofstream Payloads( PayloadFile, std::ios::binary | std::ios::app );
+  std::uint64_t Offset = Payloads.tellp();
+
+  Payloads.write( reinterpret_cast< const char * >( ThePayload.data() ),
+                  ThePayload.size() );
+
+  if( !Payloads )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "Failed to write to the solution payload file "
+                 << PayloadFile;
+
+    throw std::system_error( static_cast< int >( std::errc::io_error ),
+                             std::system_category(), ErrorMessage.str() );
+  }
+
+  std::size_t Index = TheHeader->Count;
+
+  Values< std::uint64_t >( Column::TimeStamp     )[ Index ] = TheTime;
+  Values< double        >( Column::ObjectiveValue)[ Index ] = TheObjectiveValue;
+  Values< std::uint64_t >( Column::SolveTime     )[ Index ] = TheSolveTime;
+  Values< std::uint64_t >( Column::ModelVersion  )[ Index ] = TheModelVersion;
+  Values< std::uint64_t >( Column::PayloadOffset )[ Index ] = Offset;
+  Values< std::uint64_t >( Column::PayloadLength )[ Index ] = ThePayload.size();
+
+  TheHeader->Count = Index + 1;
+}
+
+// Reading the payload is just the reverse operation.
+
+JSON SolutionHistory::Segment::Payload( std::size_t RecordIndex ) const
+{
+  std::ifstream Payloads( PayloadFile, std::ios::binary );
+  std::vector< std::uint8_t >
+  Buffer( Values< std::uint64_t >( Column::PayloadLength )[ RecordIndex ] );
+
+  Payloads.seekg( Values< std::uint64_t >( Column::PayloadOffset )[RecordIndex] );
+  Payloads.read( reinterpret_cast< char * >( Buffer.data() ), Buffer.size() );
+
+  return JSON::from_cbor( Buffer );
+}
+
+// -----------------------------------------------------------------------------
+// Segment management
+// -----------------------------------------------------------------------------
+//
+// The segment files are named by their sequence number.
+
+std::filesystem::path
+SolutionHistory::ColumnFileName( std::size_t SegmentNumber ) const
+{
+  return HistoryDirectory /
+         ( "SolutionHistory_" + std::to_string( SegmentNumber ) + ".columns" );
+}
+
+std::filesystem::path
+SolutionHistory::PayloadFileName( std::size_t SegmentNumber ) const
+{
+  return HistoryDirectory /
+         ( "SolutionHistory_" + std::to_string( SegmentNumber ) + ".payload" );
+}
+
+// Rotation closes the active segment before the new segment is created, and
+// the segment files too old to be kept are removed.
+
+void SolutionHistory::Rotate( void )
+{
+  ActiveSegment.reset();
+  CurrentSegment++;
+
+  ActiveSegment = std::make_unique< Segment >(
+    ColumnFileName( CurrentSegment ), PayloadFileName( CurrentSegment ),
+    SegmentCapacity );
+
+  while( CurrentSegment - FirstSegment + 1 > MaxSegments )
+  {
+    std::filesystem::remove( ColumnFileName ( FirstSegment ) );
+    std::filesystem::remove( PayloadFileName( FirstSegment ) );
+    FirstSegment++;
+  }
+}
+
+// The scan over the segments opens the older segments only for the duration
+// of the call to the function.
+
+template< class SegmentFunction >
+void SolutionHistory::ForEachSegment( SegmentFunction && Function ) const
+{
+  for( std::size_t SegmentNumber = FirstSegment;
+       SegmentNumber < CurrentSegment; SegmentNumber++ )
+    if( std::filesystem::exists( ColumnFileName( SegmentNumber ) ) )
+    {
+      Segment OldSegment( ColumnFileName( SegmentNumber ),
+                          PayloadFileName( SegmentNumber ), SegmentCapacity );
+      Function( OldSegment );
+    }
+
+  Function( *ActiveSegment );
+}
+
+// A record is returned as a JSON object with the scalar values and the
+// context and the solution from the payload.
+
+JSON SolutionHistory::MakeRecord( const Segment & TheSegment,
+                                  std::size_t Index, JSON TheRecord ) const
+{
+  if( TheRecord.is_null() ) TheRecord = TheSegment.Payload( Index );
+
+  TheRecord["SolveTime"]    = TheSegment.Values< std::uint64_t >(
+                              Segment::Column::SolveTime )[ Index ];
+  TheRecord["ModelVersion"] = TheSegment.Values< std::uint64_t >(
+                              Segment::Column::ModelVersion )[ Index ];
+
+  return TheRecord;
+}
+
+// -----------------------------------------------------------------------------
+// Recording solutions
+// -----------------------------------------------------------------------------
+//
+// The objective value stored is the value of the objective function that was
+// optimised, and the payload is the context and the solution messages.
+
+void SolutionHistory::Append(
+  const Solver::ApplicationExecutionContext & TheContext,
+  const Solver::Solution & TheSolution, std::uint64_t SolveTime )
+{
+  if( ActiveSegment->Full() ) Rotate();
+
+  double TheObjectiveValue = std::nan("");
+
+  if( TheSolution.contains( Solver::Solution::Keys::ObjectiveFunctionLabel ) )
+  {
+    std::string TheObjective = TheSolution.at(
+      Solver::Solution::Keys::ObjectiveFunctionLabel ).get< std::string >();
+    const JSON & ObjectiveValues
+                 = TheSolution.at( Solver::Solution::Keys::ObjectiveValues );
+
+    if( ObjectiveValues.contains( TheObjective ) &&
+        ObjectiveValues.at( TheObjective ).is_number() )
+      TheObjectiveValue = ObjectiveValues.at( TheObjective ).get< double >();
+  }
+
+  ActiveSegment->Append(
+    TheContext.at(
+      Solver::ApplicationExecutionContext::Keys::TimeStamp
+    ).get< Solver::TimePointType >(),
+    TheObjectiveValue, SolveTime,
+    TheSolution.value( Solver::Solution::Keys::ModelVersion,
+                       std::uint64_t( 0 ) ),
+    JSON::to_cbor( JSON{ { "Context",  JSON( TheContext )  },
+                         { "Solution", JSON( TheSolution ) } } ) );
+}
+
+// -----------------------------------------------------------------------------
+// Queries
+// -----------------------------------------------------------------------------
+//
+// The latest records are found from the active segment and backwards. The
+// result is collected from the most recent record and then reversed to give
+// the records in the order of increasing time.
+
+JSON SolutionHistory::Latest( std::size_t Count ) const
+{
+  JSON Result = JSON::array();
+
+  for( std::size_t SegmentNumber = CurrentSegment + 1;
+       ( SegmentNumber-- > FirstSegment ) && ( Result.size() < Count ); )
+  {
+    std::unique_ptr< Segment > OldSegment;
+
+    if( SegmentNumber < CurrentSegment )
+    {
+      if( !std::filesystem::exists( ColumnFileName( SegmentNumber ) ) )
+        continue;
+
+      OldSegment = std::make_unique< Segment >( ColumnFileName( SegmentNumber ),
+                   PayloadFileName( SegmentNumber ), SegmentCapacity );
+    }
+
+    const Segment & TheSegment = OldSegment ? *OldSegment : *ActiveSegment;
+
+    for( std::size_t Index = TheSegment.Size();
+         ( Index-- > 0 ) && ( Result.size() < Count ); )
+      Result.push_back( MakeRecord( TheSegment, Index ) );
+  }
+
+  std::ranges::reverse( Result );
+  return Result;
+}
+
+// The time range query only needs the time stamp column to select the records
+// to decode.
+
+JSON SolutionHistory::TimeRange( Solver::TimePointType From,
+                                 Solver::TimePointType To ) const
+{
+  JSON Result = JSON::array();
+
+  ForEachSegment( [&]( const Segment & TheSegment ){
+    const std::uint64_t * TimeStamps
+      = TheSegment.Values< std::uint64_t >( Segment::Column::TimeStamp );
+
+    for( std::size_t Index = 0; Index < TheSegment.Size(); Index++ )
+      if( ( From <= TimeStamps[ Index ] ) && ( TimeStamps[ Index ] <= To ) )
+        Result.push_back( MakeRecord( TheSegment, Index ) );
+  });
+
+  return Result;
+}
+
+// The distance between two contexts is computed over the numerical metrics
+// of the given context. The difference for each metric is normalised by the
+// largest magnitude of the two values, and a metric missing or non-numerical
+// in the stored context contributes the maximal normalised distance. Only
+// the best records are kept while scanning the history.
+
+JSON SolutionHistory::Nearest( const Solver::MetricValueType & TheContext,
+                               std::size_t Count ) const
+{
+  std::multimap< double, JSON > Closest;
+
+  ForEachSegment( [&]( const Segment & TheSegment ){
+    for( std::size_t Index = 0; Index < TheSegment.Size(); Index++ )
+    {
+      JSON TheRecord = TheSegment.Payload( Index );
+
+      // Records of contexts without metric values, like those that were 
+      // stored after their metric snapshot was overwritten, cannot be 
+      // compared and are skipped.
+
+      if( !TheRecord.contains( "Context" ) ||
+          !TheRecord.at( "Context" ).contains( 
+            Solver::ApplicationExecutionContext::Keys::ExecutionContext ) )
+        continue;
+
+      const JSON & StoredContext = TheRecord.at( "Context" ).at(
+        Solver::ApplicationExecutionContext::Keys::ExecutionContext );
+
+      double Distance = 0.0;
+
+      for( const auto & [ TheMetric, TheValue ] : TheContext )
+        if( TheValue.is_number() )
+        {
+          if( StoredContext.contains( TheMetric ) &&
+              StoredContext.at( TheMetric ).is_number() )
+          {
+            double Given  = TheValue.get< double >(),
+                   Stored = StoredContext.at( TheMetric ).get< double >(),
+                   Scale  = std::max({ std::fabs( Given ),
+                                       std::fabs( Stored ), 1.0 }),
+                   Delta  = ( Given - Stored ) / Scale;
+
+            Distance += Delta * Delta;
+          }
+          else
+            Distance += 1.0;
+        }
+
+      if( ( Closest.size() < Count ) ||
+          ( Distance < std::prev( Closest.end() )->first ) )
+      {
+        Closest.emplace( Distance, 
+                         MakeRecord( TheSegment, Index, std::move( TheRecord ) ) );
+
+        if( Closest.size() > Count ) Closest.erase( std::prev( Closest.end() ) );
+      }
+    }
+  });
+
+  JSON Result = JSON::array();
+
+  for( auto & [ Distance, TheRecord ] : Closest )
+  {
+    TheRecord["Distance"] = std::sqrt( Distance );
+    Result.push_back( TheRecord );
+  }
+
+  return Result;
+}
+
+// The query message is dispatched to the right query function based on the
+// query type.
+
+JSON SolutionHistory::Answer( const Query & TheQuery ) const
+{
+  std::string QueryType
+              = TheQuery.at( Query::Keys::QueryType ).get< std::string >();
+  std::size_t Count = TheQuery.value( Query::Keys::Count, std::size_t( 1 ) );
+
+  if( QueryType == Query::Type::Latest )
+    return Latest( Count );
+  else if( QueryType == Query::Type::TimeRange )
+    return TimeRange(
+      TheQuery.at( Query::Keys::From ).get< Solver::TimePointType >(),
+      TheQuery.at( Query::Keys::To   ).get< Solver::TimePointType >() );
+  else if( QueryType == Query::Type::Nearest )
+    return Nearest( Solver::MetricValueType(
+      TheQuery.at( Query::Keys::ExecutionContext ) ), Count );
+  else
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The solution history query type " << QueryType
+                 << " is not supported";
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Constructor
+// -----------------------------------------------------------------------------
+//
+// The constructor creates the history directory if needed, and looks for
+// existing segment files to find the range of segment numbers already used.
+// The last existing segment will be reopened for appending new records.
+
+SolutionHistory::SolutionHistory( const std::filesystem::path & TheDirectory,
+                                  std::size_t RecordsPerSegment,
+                                  std::size_t SegmentsToKeep )
+: HistoryDirectory( TheDirectory ),
+  SegmentCapacity( std::max< std::size_t >( RecordsPerSegment, 1 ) ),
+  MaxSegments( std::max< std::size_t >( SegmentsToKeep, 1 ) ),
+  FirstSegment( 0 ), CurrentSegment( 0 ), ActiveSegment()
+{
+  std::filesystem::create_directories( HistoryDirectory );
+
+  static constexpr std::string_view Prefix = "SolutionHistory_",
+                                    Suffix = ".columns";
+  bool SegmentsFound = false;
+
+  for( const auto & TheEntry :
+       std::filesystem::directory_iterator( HistoryDirectory ) )
+  {
+    std::string FileName = TheEntry.path().filename().string();
+
+    if( FileName.starts_with( Prefix ) && FileName.ends_with( Suffix ) )
+    {
+      std::size_t SegmentNumber;
+      auto [ End, Error ] = std::from_chars(
+        FileName.data() + Prefix.size(),
+        FileName.data() + FileName.size() - Suffix.size(), SegmentNumber );
+
+      if( Error == std::errc() )
+      {
+        FirstSegment   = SegmentsFound ? std::min( FirstSegment, SegmentNumber )
+                                       : SegmentNumber;
+        CurrentSegment = std::max( CurrentSegment, SegmentNumber );
+        SegmentsFound  = true;
+      }
+    }
+  }
+
+  ActiveSegment = std::make_unique< Segment >(
+    ColumnFileName( CurrentSegment ), PayloadFileName( CurrentSegment ),
+    SegmentCapacity );
+}
+
+} // namespace NebulOuS
@@ -0,0 +1,345 @@
+/*==============================================================================
+Solution History
+
+The solutions found by the solvers are published by the Solver Manager and
+then forgotten. Other components wanting to know a solution computed earlier,
+like dashboards or the Optimiser Controller, have then no other option than to
+resend the application execution context and wait for the solver to find the
+same solution again. The Solution History keeps an embedded, append-only record
+of the application execution context, the objective value, the solution, the
+time used to solve the problem, and the version of the model that produced the
+solution.
+
+The records are stored in segment files. Each segment consists of a column
+file that is memory mapped and holds fixed size columns for the scalar values
+of the records, and a payload file holding the application execution context
+and the solution encoded in the Concise Binary Object Representation (CBOR)
+[1] supported by the JSON library. Queries over time ranges will therefore only
+touch the contiguous time stamp column. When a segment is full, a new segment
+is started and the oldest segments are removed if there are more segments than
+the maximal number of segments to keep.
+
+The history can be queried by a message asking for the latest solution(s),
+the solutions within a time range, or the solutions found for the application
+execution contexts most similar to a given application execution context.
+
+References:
+[1] https://cbor.io/
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_SOLUTION_HISTORY
+#define NEBULOUS_SOLUTION_HISTORY
+
+// Standard headers
+
+#include <string_view>                          // Constant strings
+#include <string>                               // Normal strings
+#include <filesystem>                           // Segment files
+#include <memory>                               // Smart pointers
+#include <cstdint>                              // Fixed size integers
+#include <cstddef>                              // Byte type
+#include <vector>                               // Encoded payloads
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// AMQ communication headers
+
+#include "Communication/AMQ/AMQjson.hpp"         // For JSON messages
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Solution and contexts
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Solution History
+
+==============================================================================*/
+
+class SolutionHistory
+{
+  // --------------------------------------------------------------------------
+  // Segments
+  // --------------------------------------------------------------------------
+  //
+  // A segment holds a fixed number of records in its column file. The file
+  // starts with a header and then the columns follow, each column with one
+  // 64 bit value per record. The segment is memory mapped for the lifetime
+  // of the segment object.
+
+private:
+
+  class Segment
+  {
+  public:
+
+    enum class Column : std::size_t
+    {
+      TimeStamp,
+      ObjectiveValue,
+      SolveTime,
+      ModelVersion,
+      PayloadOffset,
+      PayloadLength,
+      NumberOfColumns
+    };
+
+  private:
+
+    struct Header
+    {
+      std::uint64_t Magic, Capacity, Count;
+    };
+
+    static constexpr std::uint64_t SegmentMagic = 0x4E65624F75534831;
+
+    const std::filesystem::path PayloadFile;
+
+    int         ColumnFile;
+    std::size_t MappedSize;
+    std::byte * MappedColumns;
+    Header    * TheHeader;
+
+  public:
+
+    // The values of a column can be accessed as a typed pointer to the first
+    // element of the column. The object values are doubles, the others are
+    // unsigned integers.
+
+    template< typename ValueType >
+    ValueType * Values( Column TheColumn ) const
+    {
+      static_assert( sizeof( ValueType ) == sizeof( std::uint64_t ) );
+
+      return reinterpret_cast< ValueType * >( MappedColumns + sizeof( Header )
+        + static_cast< std::size_t >( TheColumn ) * TheHeader->Capacity
+        * sizeof( std::uint64_t ) );
+    }
+
+    std::size_t Size( void ) const
+    { return TheHeader->Count; }
+
+    bool Full( void ) const
+    { return TheHeader->Count >= TheHeader->Capacity; }
+
+    // Appending a record writes the payload first and then the columns, and
+    // the record count is incremented only when the record is complete.
+
+    void Append( Solver::TimePointType TheTime, double TheObjectiveValue,
+                 std::uint64_t TheSolveTime, std::uint64_t TheModelVersion,
+                 const std::vector< std::uint8_t > & ThePayload );
+
+    // The payload of a record is read back and decoded on demand.
+
+    JSON Payload( std::size_t RecordIndex ) const;
+
+    // The constructor opens or creates the segment. The capacity is only
+    // used if a new segment file is created, otherwise the capacity stored
+    // in the segment file is used.
+
+    Segment( const std::filesystem::path & TheColumnFile,
+             const std::filesystem::path & ThePayloadFile,
+             std::size_t Capacity );
+
+    Segment( const Segment & Other ) = delete;
+    ~Segment();
+  };
+
+  // The segments are stored in the history directory and numbered in the
+  // order they were created. Only the current segment is kept open, and the
+  // older segments are opened when they are needed for a query.
+
+  const std::filesystem::path HistoryDirectory;
+  const std::size_t           SegmentCapacity, MaxSegments;
+
+  std::size_t FirstSegment, CurrentSegment;
+  std::unique_ptr< Segment > ActiveSegment;
+
+  std::filesystem::path ColumnFileName ( std::size_t SegmentNumber ) const;
+  std::filesystem::path PayloadFileName( std::size_t SegmentNumber ) const;
+
+  // When the active segment is full, a new segment will be created and the
+  // oldest segments removed if needed.
+
+  void Rotate( void );
+
+  // The queries are all implemented by a scan over the segments calling a
+  // function for each segment from the oldest to the newest segment.
+
+  template< class SegmentFunction >
+  void ForEachSegment( SegmentFunction && Function ) const;
+
+  // The result records are returned as JSON objects containing the scalar
+  // values of the record together with the decoded payload. The payload will
+  // be read from the segment unless it has already been decoded.
+
+  JSON MakeRecord( const Segment & TheSegment, std::size_t Index,
+                   JSON ThePayload = JSON() ) const;
+
+  // --------------------------------------------------------------------------
+  // Interface
+  // --------------------------------------------------------------------------
+  //
+  // The records are added with the context that was solved, the solution
+  // returned and the time in microseconds it took to find the solution.
+
+public:
+
+  void Append( const Solver::ApplicationExecutionContext & TheContext,
+               const Solver::Solution & TheSolution,
+               std::uint64_t SolveTime );
+
+  // There are three queries: the latest solutions, the solutions for
+  // contexts with time stamps in a time range, and the solutions for the
+  // contexts closest to a given context. The result of all queries is a JSON
+  // array of records in the order of increasing time for the two first
+  // queries, and by increasing distance for the last query.
+
+  JSON Latest  ( std::size_t Count ) const;
+  JSON TimeRange( Solver::TimePointType From, Solver::TimePointType To ) const;
+  JSON Nearest ( const Solver::MetricValueType & TheContext,
+                 std::size_t Count ) const;
+
+  // --------------------------------------------------------------------------
+  // Query messages
+  // --------------------------------------------------------------------------
+  //
+  // The query is a JSON message identifying the query type and its arguments.
+
+  class Query
+  : public TopicMessage
+  {
+  public:
+
+    static constexpr std::string_view AMQTopic
+                     = "eu.nebulouscloud.optimiser.solver.history";
+
+    // The keys of the query message are
+    //
+    // "Query" : The query type being "Latest", "TimeRange", or "Nearest"
+    // "Count" : The maximal number of records returned for the "Latest" and
+    //    the "Nearest" queries. The default is one record.
+    // "From" and "To" : The time range of the "TimeRange" query. The time
+    //    stamps are the ones of the application execution contexts.
+    // "ExecutionContext" : The metric values of the context for which the
+    //    solutions of the nearest contexts should be returned.
+    // "CorrelationID" : An optional identifier of the query that is repeated
+    //    in the response.
+    // "ReplyTo" : An optional topic where the response should be sent instead
+    //    of the general response topic.
+
+    struct Keys
+    {
+      static constexpr std::string_view
+        QueryType        = "Query",
+        Count            = "Count",
+        From             = "From",
+        To               = "To",
+        ExecutionContext =
+                Solver::ApplicationExecutionContext::Keys::ExecutionContext,
+        CorrelationID    =
+                Solver::ApplicationExecutionContext::Keys::CorrelationID,
+        ReplyTo          = Solver::ApplicationExecutionContext::Keys::ReplyTo;
+    };
+
+    struct Type
+    {
+      static constexpr std::string_view
+        Latest    = "Latest",
+        TimeRange = "TimeRange",
+        Nearest   = "Nearest";
+    };
+
+    Query( const Query & Other )
+    : TopicMessage( Other )
+    {}
+
+    Query()
+    : TopicMessage( std::string( AMQTopic ) )
+    {}
+
+    virtual ~Query() = default;
+  };
+
+  // The response repeats the query and returns the found records under the
+  // key "Solutions", or the reason under the key "Error" if the query could 
+  // not be answered. The correlation identifier of the query is repeated if
+  // it was given.
+
+  class Response
+  : public TopicMessage
+  {
+  public:
+
+    static constexpr std::string_view AMQTopic
+                     = "eu.nebulouscloud.optimiser.solver.history.response";
+
+    struct Keys
+    {
+      static constexpr std::string_view
+        QueryRequest  = "Query",
+        Solutions     = "Solutions",
+        Error         = "Error",
+        CorrelationID = Query::Keys::CorrelationID;
+    };
+
+    Response( const JSON & TheQuery, const JSON & TheSolutions )
+    : TopicMessage( std::string( AMQTopic ),
+      { { Keys::QueryRequest, TheQuery }, { Keys::Solutions, TheSolutions } } )
+    {
+      if( TheQuery.contains( Query::Keys::CorrelationID ) )
+        (*this)[ Keys::CorrelationID ] 
+          = TheQuery.at( Query::Keys::CorrelationID );
+    }
+
+    Response( const JSON & TheQuery, const std::string & TheError )
+    : Response( TheQuery, JSON::array() )
+    {
+      (*this)[ Keys::Error ] = TheError;
+    }
+
+    Response( const Response & Other )
+    : TopicMessage( Other )
+    {}
+
+    Response()
+    : TopicMessage( std::string( AMQTopic ) )
+    {}
+
+    virtual ~Response() = default;
+  };
+
+  // The query is answered by a function that dispatches the query to the
+  // right query function. An invalid argument exception is thrown if the
+  // query type is unknown.
+
+  JSON Answer( const Query & TheQuery ) const;
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The history is constructed on a directory that will be created if it does
+  // not exist. Existing segments in this directory will be reused so that the
+  // history survives restarts of the Solver Component. The number of records
+  // in each segment and the number of segments to keep can be given.
+
+  SolutionHistory( const std::filesystem::path & TheDirectory,
+                   std::size_t RecordsPerSegment = 4096,
+                   std::size_t SegmentsToKeep    = 16 );
+
+  SolutionHistory( const SolutionHistory & Other ) = delete;
+  ~SolutionHistory() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_SOLUTION_HISTORY
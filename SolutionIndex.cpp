@@ -0,0 +1,248 @@
+/*==============================================================================
+Solution Index
+
+This file implements the k-d trees of the solutions and the search for the
+solution of the nearest context.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <map>                    // Sorted metric names
+#include <numeric>                // Initial order
+#include <ranges>                 // Range algorithms
+
+#include "SolutionIndex.hpp"
+
+namespace NebulOuS
+{
+// -----------------------------------------------------------------------------
+// Keys and points
+// -----------------------------------------------------------------------------
+//
+// The metrics are sorted by name so that the coordinates are in the same order
+// for all contexts with the same metrics.
+
+std::pair< std::string, std::vector< double > >
+SolutionIndex::KeyAndPoint( const Solver::MetricValueType & TheContext,
+                            const std::string & ObjectiveFunction )
+{
+  std::string           TheKey( ObjectiveFunction );
+  std::vector< double > ThePoint;
+
+  for( const auto & [ TheMetric, TheValue ] :
+       std::map< std::string, JSON >( TheContext.begin(), TheContext.end() ) )
+    if( TheValue.is_number() )
+    {
+      TheKey += ";" + TheMetric;
+      ThePoint.push_back( TheValue.get< double >() );
+    }
+    else
+      TheKey += ";" + TheMetric + "=" + TheValue.dump();
+
+  return { TheKey, ThePoint };
+}
+
+// -----------------------------------------------------------------------------
+// Building the tree
+// -----------------------------------------------------------------------------
+//
+// The nodes are stored by index since the node vector may be reallocated when
+// the nodes of the sub-trees are added.
+
+std::size_t SolutionIndex::Build( Tree & TheTree,
+                                  std::vector< std::size_t > & Order,
+                                  std::size_t First, std::size_t Last,
+                                  std::size_t Depth )
+{
+  if( First >= Last ) return NoNode;
+
+  std::size_t Axis   = Depth % TheTree.Lower.size(),
+              Median = First + ( Last - First ) / 2,
+              TheNode = TheTree.Nodes.size();
+
+  std::nth_element( Order.begin() + First, Order.begin() + Median,
+                    Order.begin() + Last,
+                    [&]( std::size_t A, std::size_t B ){
+                      return TheTree.Entries[ A ].Point[ Axis ]
+                           < TheTree.Entries[ B ].Point[ Axis ]; } );
+
+  TheTree.Nodes.push_back( Node{ Order[ Median ], Axis, NoNode, NoNode } );
+
+  std::size_t Left  = Build( TheTree, Order, First, Median, Depth + 1 ),
+              Right = Build( TheTree, Order, Median + 1, Last, Depth + 1 );
+
+  TheTree.Nodes[ TheNode ].Left  = Left;
+  TheTree.Nodes[ TheNode ].Right = Right;
+
+  return TheNode;
+}
+
+// The oldest solutions are removed before the tree is rebuilt, and the ranges
+// of the metrics are recomputed for the kept solutions.
+
+void SolutionIndex::Rebuild( Tree & TheTree, std::size_t KeptEntries )
+{
+  if( TheTree.Entries.size() > KeptEntries )
+    TheTree.Entries.erase( TheTree.Entries.begin(),
+      TheTree.Entries.end() - static_cast< std::ptrdiff_t >( KeptEntries ) );
+
+  TheTree.Lower = TheTree.Upper = TheTree.Entries.front().Point;
+
+  for( const Entry & TheEntry : TheTree.Entries )
+    for( std::size_t Axis = 0; Axis < TheEntry.Point.size(); Axis++ )
+    {
+      TheTree.Lower[ Axis ] = std::min( TheTree.Lower[ Axis ], TheEntry.Point[ Axis ] );
+      TheTree.Upper[ Axis ] = std::max( TheTree.Upper[ Axis ], TheEntry.Point[ Axis ] );
+    }
+
+  std::vector< std::size_t > Order( TheTree.Entries.size() );
+  std::iota( Order.begin(), Order.end(), 0 );
+
+  TheTree.Nodes.clear();
+  TheTree.Root = TheTree.Lower.empty() ? NoNode
+               : Build( TheTree, Order, 0, Order.size(), 0 );
+  TheTree.BuiltSize = TheTree.Entries.size();
+}
+
+// -----------------------------------------------------------------------------
+// Searching the tree
+// -----------------------------------------------------------------------------
+//
+// The squared distance is computed on the normalised coordinates, and the
+// other side of a split is only searched if the distance to the split plane
+// is less than the distance to the best solution found so far.
+
+void SolutionIndex::Search( const Tree & TheTree, std::size_t TheNode,
+                            const std::vector< double > & ThePoint,
+                            const std::vector< double > & Scale,
+                            std::size_t & Best, double & BestDistance )
+{
+  if( TheNode == NoNode ) return;
+
+  const Node  & Split    = TheTree.Nodes[ TheNode ];
+  const Entry & TheEntry = TheTree.Entries[ Split.Solution ];
+  double TheDistance = 0.0;
+
+  for( std::size_t Axis = 0; Axis < ThePoint.size(); Axis++ )
+  {
+    double Delta = ( ThePoint[ Axis ] - TheEntry.Point[ Axis ] ) / Scale[ Axis ];
+    TheDistance += Delta * Delta;
+  }
+
+  if( TheDistance < BestDistance )
+  {
+    Best         = Split.Solution;
+    BestDistance = TheDistance;
+  }
+
+  double SplitDistance = ( ThePoint[ Split.Axis ] - TheEntry.Point[ Split.Axis ] )
+                         / Scale[ Split.Axis ];
+
+  Search( TheTree, SplitDistance < 0.0 ? Split.Left : Split.Right,
+          ThePoint, Scale, Best, BestDistance );
+
+  if( SplitDistance * SplitDistance < BestDistance )
+    Search( TheTree, SplitDistance < 0.0 ? Split.Right : Split.Left,
+            ThePoint, Scale, Best, BestDistance );
+}
+
+// The most recent solution is returned if the contexts have no numerical
+// metrics, and metrics with only one value seen have unit scale.
+
+std::optional< Solver::MetricValueType > SolutionIndex::Nearest(
+  const Solver::MetricValueType & TheContext,
+  const std::string & ObjectiveFunction ) const
+{
+  auto [ TheKey, ThePoint ] = KeyAndPoint( TheContext, ObjectiveFunction );
+  auto TheTree = Trees.find( TheKey );
+
+  if( ( TheTree == Trees.end() ) || TheTree->second.Entries.empty() )
+    return std::nullopt;
+  else if( ThePoint.empty() )
+    return TheTree->second.Entries.back().VariableValues;
+
+  std::vector< double > Scale( ThePoint.size() );
+
+  for( std::size_t Axis = 0; Axis < ThePoint.size(); Axis++ )
+  {
+    double Range = TheTree->second.Upper[ Axis ] - TheTree->second.Lower[ Axis ];
+    Scale[ Axis ] = Range > 0.0 ? Range : 1.0;
+  }
+
+  std::size_t Best         = NoNode;
+  double      BestDistance = std::numeric_limits< double >::infinity();
+
+  Search( TheTree->second, TheTree->second.Root, ThePoint, Scale,
+          Best, BestDistance );
+
+  return TheTree->second.Entries[ Best ].VariableValues;
+}
+
+// -----------------------------------------------------------------------------
+// Inserting solutions
+// -----------------------------------------------------------------------------
+//
+// A solution is added as a leaf below the node whose split it falls on,
+// unless the tree is due to be rebuilt.
+
+void SolutionIndex::Insert( const Solver::MetricValueType & TheContext,
+                            const std::string & ObjectiveFunction,
+                            const Solver::Solution & TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  if( !TheSolution.contains( Keys::VariableValues ) || 
+      !TheSolution.Solved() ) return;
+
+  JSON TheVersion = TheSolution.value( Keys::ModelVersion, JSON() );
+
+  if( TheVersion != ModelVersion )
+  {
+    Trees.clear();
+    ModelVersion = TheVersion;
+  }
+
+  auto [ TheKey, ThePoint ] = KeyAndPoint( TheContext, ObjectiveFunction );
+  Tree & TheTree = Trees[ TheKey ];
+
+  TheTree.Entries.push_back( Entry{ ThePoint,
+    TheSolution.at( Keys::VariableValues ).get< Solver::MetricValueType >() } );
+
+  if( TheTree.Entries.size() > Capacity )
+    Rebuild( TheTree, Capacity / 2 );
+  else if( TheTree.Entries.size() >= 2 * TheTree.BuiltSize )
+    Rebuild( TheTree, TheTree.Entries.size() );
+  else if( !ThePoint.empty() )
+  {
+    for( std::size_t Axis = 0; Axis < ThePoint.size(); Axis++ )
+    {
+      TheTree.Lower[ Axis ] = std::min( TheTree.Lower[ Axis ], ThePoint[ Axis ] );
+      TheTree.Upper[ Axis ] = std::max( TheTree.Upper[ Axis ], ThePoint[ Axis ] );
+    }
+
+    std::size_t TheNode = TheTree.Root, Depth = 0;
+
+    while( true )
+    {
+      Node & Split = TheTree.Nodes[ TheNode ];
+      std::size_t & Child = ThePoint[ Split.Axis ]
+                          < TheTree.Entries[ Split.Solution ].Point[ Split.Axis ]
+                          ? Split.Left : Split.Right;
+      Depth++;
+
+      if( Child == NoNode )
+      {
+        Child = TheTree.Nodes.size();
+        TheTree.Nodes.push_back( Node{ TheTree.Entries.size() - 1,
+                                       Depth % ThePoint.size(), NoNode, NoNode } );
+        break;
+      }
+      else
+        TheNode = Child;
+    }
+  }
+}
+
+}      // namespace NebulOuS
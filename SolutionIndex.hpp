@@ -0,0 +1,162 @@
+/*==============================================================================
+Solution Index
+
+AMPL starts the search for a solution from the variable values of the previous
+solution found by the solver. This is a good starting point when consecutive
+contexts are similar, like the contexts sent by the Metric Updater, but what-if
+requests may jump around in the space of metric values so that the previous
+solution is far from the new optimum. The Solution Index keeps the variable
+values of the solutions found in a k-d tree [1] over the metric values of the
+solved contexts so that the solution of the most similar context solved can
+be found quickly and used as the starting point for the search.
+
+The metric values are normalised by the range of the values seen for each
+metric so that metrics with large values do not dominate the distance. Only
+numerical metric values are used as coordinates. Contexts with different sets
+of metrics, different values of non-numerical metrics, or for different
+objective functions are kept in separate trees since their solutions are not
+comparable. All trees are cleared when a solution from a new version of the
+optimisation model is inserted.
+
+New solutions are inserted as leaves of the tree, and the tree is rebuilt as
+a balanced tree whenever its size has doubled since the last rebuild. When a
+tree has more solutions than the capacity, the oldest half of the solutions
+is forgotten as part of the rebuild.
+
+References:
+[1] J. L. Bentley: "Multidimensional binary search trees used for associative
+    searching", Communications of the ACM, Vol. 18, No. 9, pp. 509-517, 1975
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_SOLUTION_INDEX
+#define NEBULOUS_SOLUTION_INDEX
+
+// Standard headers
+
+#include <string>                               // Normal strings
+#include <vector>                               // Points and nodes
+#include <unordered_map>                        // Trees by key
+#include <optional>                             // Lookups may fail
+#include <limits>                               // Missing nodes
+#include <algorithm>                            // Maximum capacity
+#include <utility>                              // Keys and points
+#include <cstddef>                              // Sizes
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Solution and contexts
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Solution Index
+
+==============================================================================*/
+
+class SolutionIndex
+{
+  // --------------------------------------------------------------------------
+  // Trees
+  // --------------------------------------------------------------------------
+  //
+  // The solutions are stored in the order they were inserted, and the nodes
+  // of the tree refer to the solutions by their position. Each node splits
+  // the space on one axis at the coordinate of its solution.
+
+private:
+
+  static constexpr std::size_t NoNode = std::numeric_limits< std::size_t >::max();
+
+  struct Entry
+  {
+    std::vector< double >   Point;
+    Solver::MetricValueType VariableValues;
+  };
+
+  struct Node
+  {
+    std::size_t Solution, Axis, Left, Right;
+  };
+
+  struct Tree
+  {
+    std::vector< Entry >  Entries;
+    std::vector< Node >   Nodes;
+    std::vector< double > Lower, Upper;
+    std::size_t           Root = NoNode, BuiltSize = 0;
+  };
+
+  std::unordered_map< std::string, Tree > Trees;
+  JSON ModelVersion;
+
+  const std::size_t Capacity;
+
+  // The key of the tree of a context is made from the objective function, the
+  // names of the numerical metrics and the values of the other metrics, and
+  // the point is the numerical metric values in the order of the names.
+
+  static std::pair< std::string, std::vector< double > >
+  KeyAndPoint( const Solver::MetricValueType & TheContext,
+               const std::string & ObjectiveFunction );
+
+  // The balanced tree is built by splitting the solutions at the median of
+  // the axis of each level, and the search descends to the side of the split
+  // holding the point before checking the other side if it can contain a
+  // closer solution.
+
+  static std::size_t Build( Tree & TheTree, std::vector< std::size_t > & Order,
+                            std::size_t First, std::size_t Last,
+                            std::size_t Depth );
+
+  static void Rebuild( Tree & TheTree, std::size_t KeptEntries );
+
+  static void Search( const Tree & TheTree, std::size_t TheNode,
+                      const std::vector< double > & ThePoint,
+                      const std::vector< double > & Scale,
+                      std::size_t & Best, double & BestDistance );
+
+  // --------------------------------------------------------------------------
+  // Interface
+  // --------------------------------------------------------------------------
+  //
+  // The variable values of the solution for the nearest context is returned
+  // for the metric values of a context and the label of its objective
+  // function, which is empty if the context does not name an objective.
+
+public:
+
+  std::optional< Solver::MetricValueType > Nearest(
+    const Solver::MetricValueType & TheContext,
+    const std::string & ObjectiveFunction ) const;
+
+  // A solution is inserted with the metric values and the objective function
+  // label of the context it solves. Solutions without variable values are
+  // ignored, and so are the solutions of solves that failed or ended 
+  // infeasible or at a limit since they are no good starting points.
+
+  void Insert( const Solver::MetricValueType & TheContext,
+               const std::string & ObjectiveFunction,
+               const Solver::Solution & TheSolution );
+
+  // The capacity is the maximal number of solutions kept per tree
+
+  SolutionIndex( std::size_t MaxSolutions = 16384 )
+  : Trees(), ModelVersion(), Capacity( std::max< std::size_t >( MaxSolutions, 2 ) )
+  {}
+
+  SolutionIndex( const SolutionIndex & Other ) = delete;
+  ~SolutionIndex() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_SOLUTION_INDEX
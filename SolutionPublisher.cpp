@@ -0,0 +1,93 @@
+/*==============================================================================
+Solution Publisher
+
+This file implements the delivery tracking of the Solution Publisher actor
+publishing the solutions on behalf of the Solver Manager. Please see the
+header file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include "Utility/ConsolePrint.hpp"                // For logging
+
+#include "SolutionPublisher.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Delivery
+// --------------------------------------------------------------------------
+//
+// A message that fails is counted as a retry for every failed attempt, and
+// it is dropped when it has used all its attempts. The following messages
+// are then tried.
+
+void SolutionPublisher::DeliverPending( void )
+{
+  while( !PendingDeliveries.empty() )
+  {
+    PendingDelivery & TheDelivery = PendingDeliveries.front();
+
+    if( TheDelivery.Deliver() )
+      Delivered++;
+    else if( ++TheDelivery.Attempts < MaxAttempts )
+    {
+      Retried++;
+
+      if( !RetryArmed )
+      {
+        Send( Timer::WakeUp( RetryDelay ), RetryTimer.GetAddress() );
+        RetryArmed = true;
+      }
+
+      return;
+    }
+    else
+    {
+      Dropped++;
+
+      Theron::ConsoleOutput Output;
+      Output << "Solution Publisher: A message to "
+             << TheDelivery.Destination.AsString() << " was dropped after "
+             << MaxAttempts << " delivery attempts. Delivered: " << Delivered
+             << " Retried: " << Retried << " Dropped: " << Dropped
+             << std::endl;
+    }
+
+    PendingDeliveries.pop_front();
+  }
+}
+
+// --------------------------------------------------------------------------
+// Constructor and destructor
+// --------------------------------------------------------------------------
+//
+
+SolutionPublisher::SolutionPublisher( const std::string & TheActorName )
+: Actor( TheActorName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() ),
+  NetworkingActor( Actor::GetAddress().AsString() ),
+  PendingDeliveries(), Delivered( 0 ), Retried( 0 ), Dropped( 0 ),
+  RetryTimer( TheActorName + "_RetryTimer" ), RetryArmed( false )
+{
+  RegisterHandler( this, &SolutionPublisher::Publish< Solver::Solution > );
+  RegisterHandler( this, &SolutionPublisher::Publish< Solver::SolutionBatch > );
+  RegisterHandler( this, &SolutionPublisher::RetryTimeout );
+}
+
+SolutionPublisher::~SolutionPublisher()
+{
+  if( HasNetwork() )
+    DeliverPending();
+
+  if( !PendingDeliveries.empty() )
+  {
+    Theron::ConsoleOutput Output;
+    Output << "Solution Publisher: " << PendingDeliveries.size()
+           << " messages could not be delivered before closing" << std::endl;
+  }
+}
+
+} // End name space NebulOuS
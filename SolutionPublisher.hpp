@@ -0,0 +1,164 @@
+/*==============================================================================
+Solution Publisher
+
+The Solver Manager receives the solutions from the solvers, and it should
+return the solver to the pool of passive solvers and dispatch the next queued
+application execution context as soon as possible. The publication of the
+solution on the AMQ network involves encoding the message and handing it over
+to the network layer, and the manager should not wait for this before the
+solver can start on the next context. The outbound stage is therefore a
+separate actor executing on its own thread: The Solver Manager hands over the
+solution, or a batch of solutions, together with its destination address and
+continues with the dispatch.
+
+The publisher keeps track of the deliveries. A message that could not be
+handed over to the network layer is kept, and the delivery is retried when the
+retry timer expires or when the next publication arrives, whichever comes
+first. The deliveries are made in the order the publications were received so
+that a delta solution is never delivered before its base solution. A message
+that still cannot be delivered after the maximal number of attempts is dropped
+and reported on the console.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_SOLUTION_PUBLISHER
+#define NEBULOUS_SOLUTION_PUBLISHER
+
+// Standard headers
+
+#include <string>                               // Standard strings
+#include <deque>                                // Pending deliveries
+#include <functional>                           // Delivery functions
+#include <cstddef>                              // Delivery counters
+#include <chrono>                               // Retry delay
+
+// Theron++ headers
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+#include "Communication/NetworkingActor.hpp"    // Actor to receive messages
+#include "Communication/PolymorphicMessage.hpp" // The network message type
+
+// AMQ communication headers
+
+#include "Communication/AMQ/AMQEndpoint.hpp"     // AMQ endpoint
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Solution messages
+#include "Timer.hpp"                             // Delivery retries
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Solution Publisher
+
+==============================================================================*/
+
+class SolutionPublisher
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler,
+  virtual public Theron::NetworkingActor<
+    typename Theron::AMQ::Message::PayloadType >
+{
+  // --------------------------------------------------------------------------
+  // Publications
+  // --------------------------------------------------------------------------
+  //
+  // A publication is a solution message or a solution batch message together
+  // with the address of the topic it should be published to.
+
+public:
+
+  template< class MessageType >
+  class Publication
+  {
+  public:
+
+    const MessageType TheMessage;
+    const Address     Destination;
+
+    Publication( const MessageType & GivenMessage,
+                 const Address & TheDestination )
+    : TheMessage( GivenMessage ), Destination( TheDestination )
+    {}
+
+    Publication( const Publication & Other ) = default;
+    ~Publication() = default;
+  };
+
+  // --------------------------------------------------------------------------
+  // Delivery tracking
+  // --------------------------------------------------------------------------
+  //
+  // The messages not yet delivered are kept with a function sending the
+  // message, which returns true if the message was accepted for delivery,
+  // and the number of attempts made so far.
+
+  static constexpr unsigned int MaxAttempts = 5;
+  static constexpr std::chrono::milliseconds RetryDelay{ 200 };
+
+private:
+
+  struct PendingDelivery
+  {
+    std::function< bool( void ) > Deliver;
+    Address                       Destination;
+    unsigned int                  Attempts;
+  };
+
+  std::deque< PendingDelivery > PendingDeliveries;
+  std::size_t Delivered, Retried, Dropped;
+
+  // Delivering the pending messages stops at the first message that cannot
+  // be delivered so that the order of the messages is kept, and the retry 
+  // timer is then armed unless it is already waiting.
+
+  void DeliverPending( void );
+
+  Timer RetryTimer;
+  bool  RetryArmed;
+
+  void RetryTimeout( const Timer::Timeout & TheTimeout, 
+                     const Address TheTimer )
+  {
+    RetryArmed = false;
+    DeliverPending();
+  }
+
+  // The handler for the publications queues the message and delivers all
+  // pending messages.
+
+  template< class MessageType >
+  void Publish( const Publication< MessageType > & ThePublication,
+                const Address TheSolverManager )
+  {
+    PendingDeliveries.emplace_back( PendingDelivery{
+      [ this, ThePublication ](){
+        return Send( ThePublication.TheMessage, ThePublication.Destination );
+      }, ThePublication.Destination, 0 } );
+
+    DeliverPending();
+  }
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The publisher only needs a name. The destructor makes a last attempt to
+  // deliver the pending messages and reports the messages that are lost.
+
+public:
+
+  SolutionPublisher( const std::string & TheActorName );
+  SolutionPublisher( const SolutionPublisher & Other ) = delete;
+
+  virtual ~SolutionPublisher();
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_SOLUTION_PUBLISHER
@@ -0,0 +1,263 @@
+/*==============================================================================
+Solution Surrogate
+
+This file implements the nearest neighbour prediction of solutions and the
+learning and verification from the exact solutions.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <cmath>                  // Distances
+#include <algorithm>              // Minimum and maximum
+#include <map>                    // Sorted distances
+#include <vector>                 // Agreeing neighbours
+#include <sstream>                // For formatted errors
+#include <stdexcept>              // Standard exceptions
+#include <source_location>        // For better errors
+
+#include "SolutionSurrogate.hpp"
+
+namespace NebulOuS
+{
+// -----------------------------------------------------------------------------
+// Distance
+// -----------------------------------------------------------------------------
+//
+// The scaling of the differences is the same as for the nearest context query
+// of the Solution History so that the radius is a relative change of the
+// metric values.
+
+double SolutionSurrogate::Distance(
+  const std::unordered_map< std::string, double > & TheMetrics,
+  const Example & TheExample )
+{
+  double SquaredDistance = 0.0;
+
+  for( const auto & [ TheMetric, Given ] : TheMetrics )
+  {
+    auto Stored = TheExample.Metrics.find( TheMetric );
+
+    if( Stored != TheExample.Metrics.end() )
+    {
+      double Scale = std::max({ std::fabs( Given ),
+                                std::fabs( Stored->second ), 1.0 }),
+             Delta = ( Given - Stored->second ) / Scale;
+
+      SquaredDistance += Delta * Delta;
+    }
+    else
+      SquaredDistance += 1.0;
+  }
+
+  return std::sqrt( SquaredDistance );
+}
+
+// The variables are compared one by one, and the sets differ as soon as one
+// variable is missing or has a different value.
+
+bool SolutionSurrogate::SameVariables( const Solver::MetricValueType & Some,
+                                       const Solver::MetricValueType & Other )
+{
+  if( Some.size() != Other.size() ) return false;
+
+  for( const auto & [ TheVariable, SomeValue ] : Some )
+  {
+    auto OtherValue = Other.find( TheVariable );
+
+    if( OtherValue == Other.end() ) return false;
+    else if( SomeValue.is_number() && OtherValue->second.is_number() )
+    {
+      double First  = SomeValue.get< double >(),
+             Second = OtherValue->second.get< double >(),
+             Scale  = std::max({ std::fabs( First ), std::fabs( Second ), 
+                                 1.0 });
+
+      if( std::fabs( First - Second ) > VariableTolerance * Scale ) 
+        return false;
+    }
+    else if( SomeValue != OtherValue->second ) return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Prediction
+// -----------------------------------------------------------------------------
+//
+// The nearest neighbours are found by a scan over the examples of the
+// objective function keeping the closest examples in a sorted map.
+
+std::optional< SolutionSurrogate::Prediction > SolutionSurrogate::Predict(
+  const Solver::MetricValueType & TheContext,
+  const std::string & ObjectiveFunction ) const
+{
+  auto TheExamples = Examples.find( ObjectiveFunction );
+
+  if( ( TheExamples == Examples.end() ) ||
+      ( TheExamples->second.size() < Neighbours ) )
+    return std::nullopt;
+
+  std::unordered_map< std::string, double > TheMetrics;
+
+  for( const auto & [ TheMetric, TheValue ] : TheContext )
+    if( TheValue.is_number() )
+      TheMetrics.emplace( TheMetric, TheValue.get< double >() );
+
+  std::multimap< double, const Example * > Closest;
+
+  for( const Example & TheExample : TheExamples->second )
+  {
+    double TheDistance = Distance( TheMetrics, TheExample );
+
+    if( ( Closest.size() < Neighbours ) ||
+        ( TheDistance < std::prev( Closest.end() )->first ) )
+    {
+      Closest.emplace( TheDistance, &TheExample );
+
+      if( Closest.size() > Neighbours ) Closest.erase( std::prev( Closest.end() ) );
+    }
+  }
+
+  // The confidence is the agreement among the neighbours scaled by the
+  // proximity of the nearest neighbour.
+
+  const auto & [ NearestDistance, Nearest ] = *Closest.begin();
+  std::vector< std::pair< double, const Example * > > Agreeing;
+
+  for( const auto & [ TheDistance, TheExample ] : Closest )
+    if( SameVariables( TheExample->VariableValues, Nearest->VariableValues ) )
+      Agreeing.emplace_back( TheDistance, TheExample );
+
+  double Proximity  = std::max( 1.0 - NearestDistance / Radius, 0.0 ),
+         Confidence = Proximity * static_cast< double >( Agreeing.size() )
+                                / static_cast< double >( Closest.size() );
+
+  if( Confidence < Threshold ) return std::nullopt;
+
+  // The objective values are weighted by the inverse distance, and an exact
+  // match of the context gives the objective values of the matching example.
+
+  Prediction ThePrediction{ Nearest->ObjectiveValues, Nearest->VariableValues,
+                            Confidence };
+
+  if( NearestDistance > 0.0 )
+    for( auto & [ TheObjective, TheValue ] : ThePrediction.ObjectiveValues )
+      if( TheValue.is_number() )
+      {
+        double WeightedSum = 0.0, TotalWeight = 0.0;
+
+        for( const auto & [ TheDistance, TheExample ] : Agreeing )
+        {
+          auto ExampleValue = TheExample->ObjectiveValues.find( TheObjective );
+
+          if( ( ExampleValue != TheExample->ObjectiveValues.end() ) &&
+              ExampleValue->second.is_number() )
+          {
+            WeightedSum += ExampleValue->second.get< double >() / TheDistance;
+            TotalWeight += 1.0 / TheDistance;
+          }
+        }
+
+        TheValue = WeightedSum / TotalWeight;
+      }
+
+  return ThePrediction;
+}
+
+// -----------------------------------------------------------------------------
+// Learning and verification
+// -----------------------------------------------------------------------------
+//
+// Solutions without variable values are not learned as there is nothing to
+// predict from them.
+
+void SolutionSurrogate::Learn( const Solver::MetricValueType & TheContext,
+                               const std::string & ObjectiveFunction,
+                               const Solver::Solution & TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  if( !TheSolution.contains( Keys::VariableValues ) || 
+      !TheSolution.Solved() ) return;
+
+  JSON TheVersion = TheSolution.value( Keys::ModelVersion, JSON() );
+
+  if( TheVersion != ModelVersion )
+  {
+    Examples.clear();
+    ModelVersion = TheVersion;
+  }
+
+  Example TheExample{ {},
+    TheSolution.value( Keys::ObjectiveValues, Solver::MetricValueType() ),
+    TheSolution.at( Keys::VariableValues ).get< Solver::MetricValueType >() };
+
+  for( const auto & [ TheMetric, TheValue ] : TheContext )
+    if( TheValue.is_number() )
+      TheExample.Metrics.emplace( TheMetric, TheValue.get< double >() );
+
+  std::deque< Example > & TheExamples = Examples[ ObjectiveFunction ];
+
+  TheExamples.push_back( std::move( TheExample ) );
+
+  if( TheExamples.size() > Capacity ) TheExamples.pop_front();
+}
+
+bool SolutionSurrogate::Verify(
+  const Solver::MetricValueType & PredictedVariables,
+  const Solver::Solution & TheSolution )
+{
+  if( !TheSolution.Solved() ) return false;
+
+  bool Correct = TheSolution.contains( Solver::Solution::Keys::VariableValues )
+    && TheSolution.at( Solver::Solution::Keys::VariableValues ).is_object()
+    && SameVariables( PredictedVariables, 
+         TheSolution.at( Solver::Solution::Keys::VariableValues )
+                    .get< Solver::MetricValueType >() );
+
+  Accuracy = ( 1.0 - AccuracyWeight ) * Accuracy
+           + AccuracyWeight * ( Correct ? 1.0 : 0.0 );
+
+  return Correct;
+}
+
+// -----------------------------------------------------------------------------
+// Constructor
+// -----------------------------------------------------------------------------
+//
+// The parameters are validated since a threshold outside the unit interval or
+// an empty neighbourhood would make every prediction fail or succeed.
+
+SolutionSurrogate::SolutionSurrogate( double ConfidenceThreshold,
+                                      std::size_t NumberOfNeighbours,
+                                      double NeighbourhoodRadius,
+                                      std::size_t MaxExamples )
+: Examples(), ModelVersion(),
+  Neighbours( NumberOfNeighbours ), Capacity( MaxExamples ),
+  Radius( NeighbourhoodRadius ), Threshold( ConfidenceThreshold ),
+  Accuracy( ConfidenceThreshold )
+{
+  if( !( ( Threshold > 0.0 ) && ( Threshold <= 1.0 ) ) ||
+      ( Neighbours == 0 ) || !( Radius > 0.0 ) ||
+      ( Capacity < Neighbours ) )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The surrogate confidence threshold " << Threshold
+                 << " must be in (0,1], and the number of neighbours "
+                 << Neighbours << " must be positive and not larger than "
+                 << "the number of examples " << Capacity
+                 << " with a positive neighbourhood radius " << Radius;
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+}
+
+}      // namespace NebulOuS
@@ -0,0 +1,191 @@
+/*==============================================================================
+Solution Surrogate
+
+Finding the optimal configuration for an application execution context may
+take seconds, and for what-if requests an approximate answer available at once
+can be worth more than the exact answer found later. The Solution Surrogate
+learns the mapping from the metric values of the solved contexts to the
+variable values of their solutions, and predicts the solution for a new context
+from the solutions of the most similar contexts already solved, i.e. it is a
+k-nearest neighbour regression [1] on the metric values.
+
+The distance between two contexts is the Euclidean distance of the metric
+values where each difference is scaled by the larger magnitude of the two
+values, in the same way as for the nearest context query of the Solution
+History. The predicted variable values are the ones of the nearest solved
+context, and the confidence of the prediction is the fraction of the nearest
+neighbours having the same variable values, reduced linearly with the distance
+to the nearest context so that a context farther away than the neighbourhood
+radius has no confidence. The predicted objective values are the distance
+weighted average of the objective values of the agreeing neighbours.
+
+Each prediction is verified when the exact solution for the context has been
+found, and an exponentially weighted average of the fraction of the verified
+predictions that were correct is kept as the accuracy of the surrogate.
+Predictions are only offered if both the confidence of the prediction and this
+accuracy are at least the confidence threshold. Predictions made when the
+accuracy is too low are not offered, but they are still verified so that the
+accuracy can recover. All exact solutions are used as training examples, and
+the oldest examples are forgotten when the number of examples for an objective
+function reaches the capacity. All examples are forgotten when a solution from
+a new version of the optimisation model is learned since solutions of
+different models cannot be compared.
+
+References:
+[1] https://en.wikipedia.org/wiki/K-nearest_neighbors_algorithm
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_SOLUTION_SURROGATE
+#define NEBULOUS_SOLUTION_SURROGATE
+
+// Standard headers
+
+#include <string>                               // Normal strings
+#include <unordered_map>                        // Examples per objective
+#include <deque>                                // Examples in order
+#include <optional>                             // Predictions may fail
+#include <cstddef>                              // Counters
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Solution and contexts
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Solution Surrogate
+
+==============================================================================*/
+
+class SolutionSurrogate
+{
+  // --------------------------------------------------------------------------
+  // Training examples
+  // --------------------------------------------------------------------------
+  //
+  // An example holds the numeric metric values of a solved context and the
+  // objective and variable values of the solution. The examples are kept per
+  // objective function since the solutions depend on the objective optimised.
+
+private:
+
+  struct Example
+  {
+    std::unordered_map< std::string, double > Metrics;
+    Solver::MetricValueType                   ObjectiveValues,
+                                              VariableValues;
+  };
+
+  std::unordered_map< std::string, std::deque< Example > > Examples;
+  JSON ModelVersion;
+
+  // The parameters are the number of neighbours, the radius of the
+  // neighbourhood, the maximal number of examples per objective function,
+  // and the confidence threshold for offering a prediction.
+
+  const std::size_t Neighbours, Capacity;
+  const double      Radius, Threshold;
+
+  // The accuracy of the verified predictions and the weight of the latest
+  // verification in the accuracy.
+
+  static constexpr double AccuracyWeight = 0.05;
+
+  double Accuracy;
+
+  // The distance is computed over the metrics of the given context, and a
+  // metric missing from the example adds one to the squared distance.
+
+  static double Distance(
+    const std::unordered_map< std::string, double > & TheMetrics,
+    const Example & TheExample );
+
+  // Two sets of variable values are the same if they have the same variables
+  // and the numeric values differ by at most the tolerance relative to the 
+  // larger of the values and one, since the solvers return integer variables
+  // as floating point values that may be off by the integrality tolerance.
+  // Other values must be equal.
+
+  static constexpr double VariableTolerance = 1e-6;
+
+  static bool SameVariables( const Solver::MetricValueType & Some,
+                             const Solver::MetricValueType & Other );
+
+  // --------------------------------------------------------------------------
+  // Interface
+  // --------------------------------------------------------------------------
+  //
+  // A prediction returns the predicted objective values and variable values
+  // together with the confidence of the prediction.
+
+public:
+
+  struct Prediction
+  {
+    Solver::MetricValueType ObjectiveValues, VariableValues;
+    double                  Confidence;
+  };
+
+  // The prediction is made for the metric values of a context and the label
+  // of the objective function, which is empty if the context does not name
+  // an objective function. No prediction is returned if there are fewer
+  // examples than neighbours, or if the confidence of the prediction is 
+  // below the threshold.
+
+  std::optional< Prediction > Predict(
+    const Solver::MetricValueType & TheContext,
+    const std::string & ObjectiveFunction ) const;
+
+  // The exact solution is learned with the metric values and the objective
+  // label of the context it solves. Solves that failed, or ended infeasible 
+  // or at a limit, are not learned since they must never be predicted.
+
+  void Learn( const Solver::MetricValueType & TheContext,
+              const std::string & ObjectiveFunction,
+              const Solver::Solution & TheSolution );
+
+  // A prediction is verified by comparing the predicted variable values with
+  // the variable values of the exact solution within the variable tolerance.
+  // The function returns true if the prediction was correct. A prediction
+  // cannot be verified by a solve that did not succeed, and the accuracy is 
+  // then left unchanged.
+
+  bool Verify( const Solver::MetricValueType & PredictedVariables,
+               const Solver::Solution & TheSolution );
+
+  // The predictions should only be offered if the surrogate is trusted, 
+  // i.e. if the accuracy of the verified predictions is at least the 
+  // confidence threshold.
+
+  bool Trusted( void ) const
+  { return Accuracy >= Threshold; }
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The confidence threshold must be given, and it is also the initial
+  // accuracy so that predictions are offered until verifications show that
+  // they are wrong too often.
+
+  SolutionSurrogate( double ConfidenceThreshold,
+                     std::size_t NumberOfNeighbours = 5,
+                     double NeighbourhoodRadius     = 0.1,
+                     std::size_t MaxExamples        = 4096 );
+
+  SolutionSurrogate( const SolutionSurrogate & Other ) = delete;
+  ~SolutionSurrogate() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_SOLUTION_SURROGATE
@@ -38,7 +38,11 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <string_view>                          // Constant strings
 #include <string>                               // Normal strings
 #include <unordered_map>                        // To store metric-value maps
+#include <vector>                               // Lists of names
 #include <concepts>                             // To test template parameters
+#include <cstdint>                              // Snapshot versions
+#include <memory>                               // Shared context views
+#include <utility>                              // Forwarding field values
 
 // Other packages
 
@@ -58,6 +62,11 @@ using JSON = nlohmann::json;                    // Short form name space
 #include "Communication/AMQ/AMQEndpoint.hpp"     // Enabling AMQ communication
 #include "Communication/AMQ/AMQSessionLayer.hpp" // For topic subscriptions
 
+// NebulOuS headers
+
+#include "MessageEncoding.hpp"                   // Binary message encodings
+#include "MessageView.hpp"                       // Typed message views
+
 namespace NebulOuS
 {
 /*==============================================================================
@@ -105,7 +114,7 @@ public:
   // received on the topic with the same name as the message identifier.
 
   class ApplicationExecutionContext
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -146,7 +155,62 @@ public:
     //    this reason there is a flag in the message indicating whether the 
     //    solution should be deployed, and its default value is 'false' to 
     //    prevent solutions form accidentially being deployed.
-
+    // "CorrelationID" : An optional string or number chosen by the requester
+    //    that will be copied to the solution for this context. The time stamp
+    //    is not unique when there are many concurrent requesters, and the 
+    //    correlation identifier allows a requester to have many outstanding 
+    //    requests.
+    // "ReplyTo" : An optional topic name where the solution should be sent. 
+    //    If this is not given, the solution is published on the general 
+    //    solution topic. A reply to a local actor is given as the local reply
+    //    prefix followed by the actor name, and the solution is then sent to
+    //    the actor without passing through the AMQ broker.
+    // "ContextID" : An optional identifier of the context that can be used 
+    //    as the base context for later delta contexts. If it is not given, 
+    //    the correlation identifier is used, or the time stamp if there is 
+    //    no correlation identifier.
+    // "BaseContext" : If this is given, the context is a delta context and 
+    //    the execution context contains only the metrics whose values have
+    //    changed relative to the base context. The base context is the 
+    //    identifier of an earlier context, or "Latest" for the previously 
+    //    received context. The delta context is resolved by the Solver 
+    //    Manager before it is dispatched to a solver.
+    // "BatchSolution" : A requester submitting many contexts, for instance 
+    //    for simulations, may ask for the solutions to be published in 
+    //    batches of several solutions per message by setting this flag. The 
+    //    flag is only used for contexts with a reply address, and it is 
+    //    ignored for solutions that should be deployed.
+    // "SnapshotVersion" : Contexts created inside the Solver Component may 
+    //    refer to a snapshot of the metric values in the Metric Snapshot 
+    //    Store instead of containing the execution context. The solver will
+    //    then read the metric values from the referenced snapshot.
+    // "Approximate" : A requester of what-if solutions may accept a solution
+    //    predicted from the solutions of similar contexts already solved. If
+    //    the Solver Manager has a trusted prediction, it is published at once
+    //    and the exact solution is published when it has been found. The 
+    //    flag is ignored for solutions that should be deployed.
+    // "WarmStart" : An optional map of variable names and values used as the
+    //    starting point for the search for the optimal solution. The Solver
+    //    Manager sets the variable values of the solution of the nearest 
+    //    context already solved if warm starts are enabled and the context 
+    //    does not give its own starting point.
+    // "VariableBounds" : An optional map of variable names to an array with 
+    //    a lower and an upper bound that should be used instead of the bounds
+    //    declared in the model. The solver falls back to the declared bounds
+    //    if the problem is infeasible under the given bounds, or if the 
+    //    solution lies on one of the given bounds.
+    // "Neighbourhood" : An optional time limit in seconds that asks for a 
+    //    neighbourhood search around the deployed configuration instead of
+    //    solving the full problem. The configuration variables are fixed to
+    //    their deployed values except for a small subset that is optimised,
+    //    and the subset grows until a better configuration is found or the
+    //    time limit is reached.
+    // "Candidates" : An optional array of candidate configurations, each a
+    //    map of variable names and values. If this is given, the problem is 
+    //    not optimised but the objective values and the constraint violations
+    //    are evaluated for each candidate under the metric values of the 
+    //    context, and returned in the solution. Variables not given by a 
+    //    candidate keep the values of the previous solution.
 
     struct Keys
     {
@@ -154,9 +218,128 @@ public:
         TimeStamp               = "Timestamp",
         ObjectiveFunctionLabel  = "ObjectiveFunction",
         ExecutionContext        = "ExecutionContext",
-        DeploymentFlag          = "DeploySolution";
+        DeploymentFlag          = "DeploySolution",
+        CorrelationID           = "CorrelationID",
+        ReplyTo                 = "ReplyTo",
+        ContextID               = "ContextID",
+        BaseContext             = "BaseContext",
+        BatchSolution           = "BatchSolution",
+        SnapshotVersion         = "SnapshotVersion",
+        Approximate             = "Approximate",
+        WarmStart               = "WarmStart",
+        VariableBounds          = "VariableBounds",
+        Neighbourhood           = "Neighbourhood",
+        Candidates              = "Candidates";
     };
 
+    // The base context label used to refer to the previous context
+
+    static constexpr std::string_view LatestContext = "Latest";
+
+    // The prefix of reply addresses for local actors. Any text after a '#' 
+    // following the actor name is ignored when routing the solution.
+
+    static constexpr std::string_view LocalReply = "local:";
+
+    // Reply topics on the AMQ broker must be in the NebulOuS topic name space
+    // so that a requester cannot make the Solver Component publish on any 
+    // topic of the broker.
+
+    static constexpr std::string_view ReplyTopicPrefix = "eu.nebulouscloud.";
+
+    // The handlers read the context through a typed view. Only the time 
+    // stamp is mandatory since the execution context may be given by a 
+    // snapshot version instead.
+
+    using View = MessageView< 
+      MessageField< Keys::TimeStamp,              TimePointType,   true  >,
+      MessageField< Keys::ObjectiveFunctionLabel, std::string,     false >,
+      MessageField< Keys::ExecutionContext,       MetricValueType, false >,
+      MessageField< Keys::DeploymentFlag,         bool,            false >,
+      MessageField< Keys::CorrelationID,          JSON,            false >,
+      MessageField< Keys::ReplyTo,                std::string,     false >,
+      MessageField< Keys::ContextID,              std::string,     false >,
+      MessageField< Keys::BaseContext,            std::string,     false >,
+      MessageField< Keys::BatchSolution,          bool,            false >,
+      MessageField< Keys::SnapshotVersion,        std::uint64_t,   false >,
+      MessageField< Keys::Approximate,            bool,            false >,
+      MessageField< Keys::WarmStart,              MetricValueType, false >,
+      MessageField< Keys::VariableBounds,         MetricValueType, false >,
+      MessageField< Keys::Neighbourhood,          double,          false >,
+      MessageField< Keys::Candidates, std::vector< MetricValueType >, false > >;
+
+    // The view is decoded once when the context is received from the 
+    // network, or the first time it is read for a context created locally,
+    // and it is shared by the copies of the context made when the context is
+    // passed from the Solver Manager to a solver. A context must therefore 
+    // be changed through the functions setting or removing a field, which 
+    // change the view accordingly, once the view has been decoded.
+
+  private:
+
+    mutable std::shared_ptr< const View > DecodedView;
+
+    std::shared_ptr< View > ChangedView( void ) const
+    {
+      if( DecodedView ) return std::make_shared< View >( *DecodedView );
+      else              return std::shared_ptr< View >();
+    }
+
+  protected:
+
+    virtual bool Initialize( 
+      const Theron::AMQ::Message::PayloadType & ThePayload ) noexcept override
+    {
+      if( !TopicMessage::Initialize( ThePayload ) ) return false;
+
+      // An invalid context is reported by the handler reading the view.
+
+      try
+      {
+        DecodedView = std::make_shared< const View >( *this );
+      }
+      catch( ... )
+      {
+        DecodedView.reset();
+      }
+
+      return true;
+    }
+
+  public:
+
+    const View & GetView( void ) const
+    {
+      if( !DecodedView ) 
+        DecodedView = std::make_shared< const View >( *this );
+
+      return *DecodedView;
+    }
+
+    template< const std::string_view & Key, typename ValueType >
+    void Set( ValueType && TheValue )
+    {
+      (*this)[ Key ] = TheValue;
+
+      if( auto TheView = ChangedView() )
+      {
+        TheView->template Set< Key >( std::forward< ValueType >( TheValue ) );
+        DecodedView = TheView;
+      }
+    }
+
+    template< const std::string_view & Key >
+    void Erase( void )
+    {
+      this->erase( Key );
+
+      if( auto TheView = ChangedView() )
+      {
+        TheView->template Erase< Key >();
+        DecodedView = TheView;
+      }
+    }
+
     // The full constructor takes the time point, the objective function to 
     // solve for, and the application's execution context as the metric map
 
@@ -164,7 +347,7 @@ public:
                                  const std::string ObjectiveFunctionID,
                                  const MetricValueType & TheContext,
                                  bool DeploySolution = false )
-    : JSONTopicMessage( std::string( AMQTopic ),
+    : TopicMessage( std::string( AMQTopic ),
     { { Keys::TimeStamp, MicroSecondTimePoint },
       { Keys::ObjectiveFunctionLabel, ObjectiveFunctionID },
       { Keys::ExecutionContext, TheContext },
@@ -178,23 +361,35 @@ public:
     ApplicationExecutionContext( const TimePointType MicroSecondTimePoint,
                                  const MetricValueType & TheContext,
                                  bool DeploySolution = false )
-    : JSONTopicMessage( std::string( AMQTopic ),
+    : TopicMessage( std::string( AMQTopic ),
     { { Keys::TimeStamp, MicroSecondTimePoint },
       { Keys::ExecutionContext, TheContext },
       { Keys::DeploymentFlag, DeploySolution }
     }) {}
 
+    // A context referring to a metric value snapshot has the snapshot 
+    // version instead of the execution context.
+
+    ApplicationExecutionContext( const TimePointType MicroSecondTimePoint,
+                                 const std::uint64_t TheSnapshotVersion,
+                                 bool DeploySolution = false )
+    : TopicMessage( std::string( AMQTopic ),
+    { { Keys::TimeStamp, MicroSecondTimePoint },
+      { Keys::SnapshotVersion, TheSnapshotVersion },
+      { Keys::DeploymentFlag, DeploySolution }
+    }) {}
+
     // The copy constructor simply passes the job on to the JSON Topic
-    // message for copying the message
+    // message for copying the message, and shares the decoded view
 
     ApplicationExecutionContext( const ApplicationExecutionContext & Other )
-    : JSONTopicMessage( Other )
+    : TopicMessage( Other ), DecodedView( Other.DecodedView )
     {}
 
     // The default constructor simply stores the message identifier
 
     ApplicationExecutionContext()
-    : JSONTopicMessage( std::string( AMQTopic ) )
+    : TopicMessage( std::string( AMQTopic ) )
     {}
 
     // The default destrucor is used
@@ -233,7 +428,7 @@ protected:
 public:
 
   class Solution
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -249,7 +444,8 @@ public:
                      = "eu.nebulouscloud.optimiser.solver.solution";
 
     // Most of the message keys are the same as for the application execution 
-    // context, but there are two new:
+    // context, and the correlation identifier and the reply topic are copied
+    // from the context if they are given. There are two new keys:
     //
     // "ObjectiveValues" : This holds a map of objective function names and 
     //    their values under the currently found solution which is optimised
@@ -259,12 +455,59 @@ public:
     // "VariableValues" : This key is a map holding the variable names and 
     //    their values found by the solver for the optimal solution. This is
     //    used to reconfigure the application.
+    // "ModelVersion" : An optional unsigned integer identifying the version 
+    //    of the optimisation model used to find the solution. Solutions found
+    //    with different models should not be compared.
+    // "SolutionID" : An unsigned integer set by the Solver Manager when the 
+    //    solution is published, identifying the solution uniquely among the 
+    //    solutions published by the Solver Manager.
+    // "BaseSolution" : If delta solutions are enabled, a solution may be 
+    //    published with only the variables whose values changed relative to
+    //    the previous solution published to the same topic for the same 
+    //    objective function. The base solution is the solution identifier of
+    //    the previous solution, and the full variable values are obtained by
+    //    updating the variable values of the base solution with the values 
+    //    of the delta solution. A solution without a base solution is always
+    //    a full solution.
+    // "SolveTime" : An optional number of microseconds used by the solver to
+    //    find the solution, not including the time waiting in the queue.
+    // "SolveResult" : The AMPL result code of the solve giving the solution.
+    //    Codes below 200 are successful solves, and codes of 200 and above 
+    //    are infeasible, unbounded, interrupted by a limit, or failed solves
+    //    whose variable values are not a solution to the problem. Solutions 
+    //    found by enumerating the configurations have the code zero.
+    // "Predicted" : Set to true for a solution predicted by the Solver 
+    //    Manager for a context asking for an approximate solution. The exact
+    //    solution for the same context follows later without this flag.
+    // "Confidence" : The confidence in [0,1] of a predicted solution.
+    // "CandidateEvaluations" : The evaluations of the candidates of a context
+    //    in the order of the candidates. Each evaluation holds the objective
+    //    values under the "ObjectiveValues" key, a map from the names of the
+    //    violated constraints to the amount of the violation under the key
+    //    "Violations", and a "Feasible" flag set if no constraint is 
+    //    violated. The objective values and the variable values of the 
+    //    solution itself are then empty.
+    // "Error" : The reason why no solution could be found for the context, 
+    //    for instance if the context is invalid or if the solver failed. A 
+    //    failed solution has no objective values and no variable values, and
+    //    it is only returned to requesters giving a reply address.
 
     struct Keys : public ApplicationExecutionContext::Keys
     {
       static constexpr std::string_view
-        ObjectiveValues = "ObjectiveValues",
-        VariableValues  = "VariableValues";
+        ObjectiveValues      = "ObjectiveValues",
+        VariableValues       = "VariableValues",
+        ModelVersion         = "ModelVersion",
+        SolutionID           = "SolutionID",
+        BaseSolution         = "BaseSolution",
+        SolveTime            = "SolveTime",
+        SolveResult          = "SolveResult",
+        Predicted            = "Predicted",
+        Confidence           = "Confidence",
+        CandidateEvaluations = "CandidateEvaluations",
+        Violations           = "Violations",
+        Feasible             = "Feasible",
+        Error                = "Error";
     };
     
     Solution( const TimePointType MicroSecondTimePoint,
@@ -272,7 +515,7 @@ public:
               const ObjectiveValuesType & TheObjectiveValues,
               const VariableValuesType & TheVariables,
               bool DeploySolution )
-    : JSONTopicMessage( std::string( AMQTopic ) ,
+    : TopicMessage( std::string( AMQTopic ) ,
       { { Keys::TimeStamp, MicroSecondTimePoint   },
         { Keys::ObjectiveFunctionLabel, ObjectiveFunctionID },
         { Keys::ObjectiveValues, TheObjectiveValues },
@@ -280,12 +523,82 @@ public:
         { Keys::DeploymentFlag, DeploySolution }
       } )
       {}
+
+    // A solution can also be constructed from a JSON object holding the 
+    // fields of a solution, for instance to re-publish a previous solution.
+
+    Solution( const JSON & TheSolution )
+    : TopicMessage( std::string( AMQTopic ), TheSolution )
+    {}
+
+    // A failed solution is constructed from the context that failed with the
+    // reason for the failure. The fields needed to route the reply to the 
+    // requester are copied from the context if they are given.
+
+    Solution( const JSON & TheContext, const std::string & TheError )
+    : TopicMessage( std::string( AMQTopic ), { { Keys::Error, TheError } } )
+    {
+      for( std::string_view TheKey : { Keys::TimeStamp, 
+             Keys::ObjectiveFunctionLabel, Keys::CorrelationID, 
+             Keys::ReplyTo, Keys::BatchSolution } )
+        if( TheContext.is_object() && TheContext.contains( TheKey ) )
+          (*this)[ TheKey ] = TheContext.at( TheKey );
+    }
+
+    Solution( const Solution & Other )
+    : TopicMessage( Other )
+    {}
     
     Solution()
-    : JSONTopicMessage( std::string( AMQTopic ) )
+    : TopicMessage( std::string( AMQTopic ) )
     {}
 
     virtual ~Solution() = default;
+
+    // A solution is only a solution to the problem if it did not fail and if
+    // the solve result, if given, is successful. The other solutions must
+    // not be learned from.
+
+    bool Solved( void ) const
+    {
+      return !contains( Keys::Error ) && 
+             ( value( Keys::SolveResult, 0 ) < 200 );
+    }
+  };
+
+  // Solutions requested with the batch flag are published together as an 
+  // array of solutions under the key "Solutions" in one message sent to the
+  // reply address of the requester. The batch is a different message from 
+  // the solution, and it is never published on the shared solution topic 
+  // since the receivers of this topic expect single solutions.
+
+  class SolutionBatch
+  : public TopicMessage
+  {
+  public:
+
+    static constexpr std::string_view AMQTopic 
+                     = "eu.nebulouscloud.optimiser.solver.solution.batch";
+
+    struct Keys
+    {
+      static constexpr std::string_view Solutions = "Solutions";
+    };
+
+    SolutionBatch( const JSON & TheSolutions )
+    : TopicMessage( std::string( AMQTopic ), 
+                    { { Keys::Solutions, TheSolutions } } )
+    {}
+
+    SolutionBatch( const SolutionBatch & Other )
+    : TopicMessage( Other )
+    {}
+
+    SolutionBatch()
+    : TopicMessage( std::string( AMQTopic ) )
+    {}
+
+    virtual ~SolutionBatch() = default;
   };
 
   // --------------------------------------------------------------------------
@@ -299,7 +612,7 @@ public:
   // to implement this in a way appropriate for the algorithm. 
 
   class OptimisationProblem
-  : public Theron::AMQ::JSONTopicMessage
+  : public TopicMessage
   {
   public:
 
@@ -307,11 +620,11 @@ public:
            = "eu.nebulouscloud.optimiser.controller.model";
 
     OptimisationProblem( const JSON & TheProblem )
-    : JSONTopicMessage( std::string( AMQTopic ), TheProblem )
+    : TopicMessage( std::string( AMQTopic ), TheProblem )
     {}
 
     OptimisationProblem()
-    : JSONTopicMessage( std::string( AMQTopic ) )
+    : TopicMessage( std::string( AMQTopic ) )
     {}
 
     virtual ~OptimisationProblem() = default;
@@ -323,6 +636,83 @@ public:
   virtual void DefineProblem( const OptimisationProblem & TheProblem, 
                               const Address TheOracle ) = 0;
 
+  // When the problem has been defined, the solver should publish the names 
+  // of the parameters declared by the model. The metrics listed by the 
+  // Optimiser Controller that are not parameters of the model will then not 
+  // be needed in the application execution context, and the Metric Updater 
+  // does not need to track their values. The parameter names are sent as a 
+  // JSON array under the key "Parameters".
+
+  class ModelParameters
+  : public TopicMessage
+  {
+  public:
+
+    static constexpr std::string_view AMQTopic 
+           = "eu.nebulouscloud.optimiser.solver.model_parameters";
+
+    struct Keys
+    {
+      static constexpr std::string_view Parameters = "Parameters";
+    };
+
+    ModelParameters( const std::vector< std::string > & TheParameters )
+    : TopicMessage( std::string( AMQTopic ), 
+                        { { Keys::Parameters, TheParameters } } )
+    {}
+
+    ModelParameters( const ModelParameters & Other )
+    : TopicMessage( Other )
+    {}
+
+    ModelParameters()
+    : TopicMessage( std::string( AMQTopic ) )
+    {}
+
+    virtual ~ModelParameters() = default;
+  };
+
+  // --------------------------------------------------------------------------
+  // Thread budget
+  // --------------------------------------------------------------------------
+  //
+  // Many back-end solvers are multi-threaded and will by default use all the 
+  // cores of the machine. When several solvers in the pool run concurrently,
+  // the machine will be heavily oversubscribed. The Solver Manager therefore 
+  // allocates a share of the available cores to each solver, and sends the 
+  // thread budget to the solver just before the application execution context
+  // is dispatched. The budget is valid for the next solve only. It is a local 
+  // message, and it is up to the solver algorithm to decide how the budget is 
+  // passed on to the back-end solver.
+
+public:
+
+  class ThreadBudget
+  {
+  public:
+
+    const unsigned int Threads;
+
+    ThreadBudget( const unsigned int NumberOfThreads )
+    : Threads( NumberOfThreads )
+    {}
+
+    ThreadBudget( const ThreadBudget & Other ) = default;
+    ~ThreadBudget() = default;
+  };
+
+  // The default handler just records the number of threads allowed. A value
+  // of zero means that no budget has been given and the solver is free to 
+  // use its default number of threads.
+
+protected:
+
+  unsigned int ThreadLimit;
+
+  virtual void SetThreadBudget( const ThreadBudget & TheBudget, 
+                                const Address TheSolverManager )
+  { ThreadLimit = TheBudget.Threads; }
+
   // --------------------------------------------------------------------------
   // Constructor and destructor
   // --------------------------------------------------------------------------
@@ -340,23 +730,30 @@ public:
   // destructor unsubscribes from the topics previously subscribed to by 
   // the constuctor.
 
+public:
+
   Solver( const std::string & TheSolverName )
   : Actor( TheSolverName ),
     StandardFallbackHandler( Actor::GetAddress().AsString() ),
-    NetworkingActor( Actor::GetAddress().AsString() )
+    NetworkingActor( Actor::GetAddress().AsString() ),
+    ThreadLimit( 0 )
   {
-    RegisterHandler( this, &Solver::SolveProblem  );
-    RegisterHandler( this, &Solver::DefineProblem );
-
-    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
-      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
-      OptimisationProblem::AMQTopic
-    ), GetSessionLayerAddress() );
-
-    Send( Theron::AMQ::NetworkLayer::TopicSubscription(
-      Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
-      ApplicationExecutionContext::AMQTopic
-    ), GetSessionLayerAddress() );
+    RegisterHandler( this, &Solver::SolveProblem    );
+    RegisterHandler( this, &Solver::DefineProblem   );
+    RegisterHandler( this, &Solver::SetThreadBudget );
+
+    if( HasNetwork() )
+    {
+      Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+        Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+        OptimisationProblem::AMQTopic
+      ), GetSessionLayerAddress() );
+
+      Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+        Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription,
+        ApplicationExecutionContext::AMQTopic
+      ), GetSessionLayerAddress() );
+    }
   }
   
   Solver() = delete;
@@ -13,26 +13,73 @@ The command line arguments that can be givne to the Solver Component are
 
 -A or --AMPLDir <installation directory> for the AMPL model interpreter
 -B or --broker <URL> for the location of the AMQ broker
+-C or --FlowControl <Default|HighRate|LowRate> Flow control of received messages
 -E or --endpoint <name> The endpoint name = application identifier 
+-H or --HistoryDir <directory> for the solution history (no history if empty)
+-I or --MetricShards <n> Number of actors receiving the metric predictions
+-K or --Keyframes <n> Publish delta solutions with a full solution every n
+-L or --LocalSocket <path> Unix socket for contexts from co-located clients
 -M ir --ModelDir <directory> for model and data files
 -N or --name The AMQ identity of the solver (see below)
 -P or --port <n> the port to use on the AMQ broker URL
+-R or --Credit <n> The credit window of the receiving links (0 = preset)
 -S or --Solver <label> The back-end solver used by AMPL
 -U or --user <user> the user to authenticate for the AMQ broker
+-W or --WildcardMetrics Use one wildcard subscription for all metric predictions
+-X or --Surrogate <confidence> Confidence threshold for predicted solutions
+-Y or --WarmStart Start from the solution of the nearest solved context
+-Z or --TightenBounds Bound the variables by the ranges of earlier solutions
 -Pw or --password <password> the AMQ broker password for the user
+--Solvers <n> The number of solvers in the solver pool
+--Enumerate <n> Enumerate integer models with at most n configurations
 -? or --Help prints a help message for the options
 
+Batch mode options:
+
+--Batch <file> Solve the contexts of the file, one per line, ("-" for stdin)
+--Model <file> The AMPL model file to load in batch mode
+--Data <file> The optional AMPL data file to load in batch mode
+--Objective <label> The default objective function of the model
+--Output <file> The file for the solutions, one per line, in batch mode
+--TrainingSet <file> Solve sampled contexts and write them to this CSV file
+--Ranges <file> JSON file with the [min, max] range of each sampled metric
+--Samples <n> The number of contexts to sample for the training set
+--Sampling <Sobol|LHS> The sampling method for the training set
+--Seed <n> The seed of the Latin hypercube sampling
+
 Default values:
 
 -A taken from the standard AMPL environment variables if omitted
 -B localhost
+-C Default (the AMQ library defaults)
 -E <no default - must be given>
+-H <empty - no solution history is kept>
+-I 0 (the metric predictions are received by the Metric Updater)
+-K 0 (all solutions are published in full)
+-L <empty - no local socket is opened>
 -M <temporary directory created by the OS>
 -N "NebulOuS::Solver"
 -P 5672
+-R 0 (the credit window of the flow control preset)
 -S couenne
 -U admin
+-X 0 (no solutions are predicted)
+-Y false (the solver starts from its previous solution)
+-Z false (the variables have the bounds declared in the model)
 -Pw admin
+--Solvers 1
+--Enumerate 0 (all problems are solved by AMPL)
+--Batch <empty - the Solver Component connects to the AMQ broker>
+--TrainingSet <empty - no training set is generated>
+--Samples 1000
+--Sampling Sobol
+--Seed 1
+
+In batch mode no connection is made to the AMQ broker, and the endpoint name
+is not needed. The model is loaded from the given files, and the component 
+terminates when all contexts have been solved. The training set generation 
+is a batch mode where the contexts are sampled from the metric ranges instead 
+of being read from a file, and it takes the same model options.
 
 A note on the mandatory endpoint name defining the extension used for the 
 solver component when connecting to the AMQ server. Typically the connection 
@@ -78,6 +125,8 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <stdexcept>        // standard exceptions
 #include <filesystem>       // Access to the file system
 #include <map>              // For extended AMQ properties
+#include <memory>           // For the optional local query server
+#include <cstdint>          // For the sampling seed
 
 // Theron++ headers
 
@@ -114,6 +163,11 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include "MetricUpdater.hpp"
 #include "SolverManager.hpp"
 #include "AMPLSolver.hpp"
+#include "LocalQueryServer.hpp"
+#include "FlowControl.hpp"
+#include "BatchRunner.hpp"
+#include "ContextSampler.hpp"
+#include "TrainingSetGenerator.hpp"
 
 /*==============================================================================
 
@@ -135,19 +189,63 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
         cxxopts::value<std::string>()->default_value("") )
     ("B,Broker", "The URL of the AMQ broker", 
         cxxopts::value<std::string>()->default_value("localhost") )
+    ("C,FlowControl", "Flow control preset: Default, HighRate or LowRate",
+        cxxopts::value<std::string>()->default_value("Default") )
     ("E,Endpoint", "The endpoint name", cxxopts::value<std::string>() )
+    ("H,HistoryDir", "Directory to store the solution history",
+        cxxopts::value<std::string>()->default_value("") )
+    ("I,MetricShards", "Number of actors receiving metric predictions",
+        cxxopts::value<unsigned int>()->default_value("0") )
+    ("K,Keyframes", "Full solution interval for delta solutions (0 = no deltas)",
+        cxxopts::value<unsigned int>()->default_value("0") )
+    ("L,LocalSocket", "Unix socket path for local context requests",
+        cxxopts::value<std::string>()->default_value("") )
     ("M,ModelDir", "Directory to store the model and its data",
         cxxopts::value<std::string>()->default_value("") )
     ("N,Name", "The name of the Solver Component",
         cxxopts::value<std::string>()->default_value("NebulOuS::Solver") )
     ("P,Port", "TCP port on  AMQ Broker", 
         cxxopts::value<unsigned int>()->default_value("5672") )
+    ("R,Credit", "Credit window of receiving links (0 = preset value)",
+        cxxopts::value<unsigned int>()->default_value("0") )
     ("S,Solver", "Solver to use, default Couenne",
         cxxopts::value<std::string>()->default_value("couenne") )
     ("U,User", "The user name used for the AMQ Broker connection", 
         cxxopts::value<std::string>()->default_value("admin") )
     ("Pw,Password", "The password for the AMQ Broker connection", 
         cxxopts::value<std::string>()->default_value("admin") )
+    ("W,WildcardMetrics", "One subscription for all metric predictions",
+        cxxopts::value<bool>()->default_value("false") )
+    ("X,Surrogate", "Confidence threshold for predicted solutions (0 = none)",
+        cxxopts::value<double>()->default_value("0") )
+    ("Y,WarmStart", "Start from the solution of the nearest solved context",
+        cxxopts::value<bool>()->default_value("false") )
+    ("Z,TightenBounds", "Bound the variables by the ranges of earlier solutions",
+        cxxopts::value<bool>()->default_value("false") )
+    ("Solvers", "Number of solvers in the solver pool",
+        cxxopts::value<unsigned int>()->default_value("1") )
+    ("Enumerate", "Enumerate integer models up to this many configurations",
+        cxxopts::value<std::size_t>()->default_value("0") )
+    ("Batch", "File of contexts to solve without AMQ broker (- for stdin)",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Model", "The AMPL model file for batch mode",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Data", "The AMPL data file for batch mode",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Objective", "The default objective function for batch mode",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Output", "The solution file for batch mode (mandatory)",
+        cxxopts::value<std::string>()->default_value("") )
+    ("TrainingSet", "CSV file for a training set of sampled contexts",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Ranges", "JSON file with the range of each sampled metric",
+        cxxopts::value<std::string>()->default_value("") )
+    ("Samples", "Number of sampled contexts for the training set",
+        cxxopts::value<std::size_t>()->default_value("1000") )
+    ("Sampling", "The sampling method for the training set: Sobol or LHS",
+        cxxopts::value<std::string>()->default_value("Sobol") )
+    ("Seed", "The seed for the Latin hypercube sampling",
+        cxxopts::value<std::uint64_t>()->default_value("1") )
     ("h,help", "Print help information");
 
   CLIOptions.allow_unrecognised_options();
@@ -160,6 +258,13 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
     exit( EXIT_SUCCESS );
   }
 
+  // In batch mode the contexts are read from a file, or sampled for a 
+  // training set, and there is no AMQ broker involved.
+
+  const bool TrainingMode = !CLIValues["TrainingSet"].as<std::string>().empty(),
+             BatchMode    = TrainingMode 
+                            || !CLIValues["Batch"].as<std::string>().empty();
+
   // --------------------------------------------------------------------------
   // Validating directories
   // --------------------------------------------------------------------------
@@ -214,7 +319,8 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
   // provided as a user specified class to allow the user full fexibility in 
   // deciding on the connection properties. This class should keep the user 
   // name, the password, and the application identifier, which is identical 
-  // to the endpoint.
+  // to the endpoint. The flow control policy for the receiving links is also
+  // kept by the options.
 
   class AMQOptions
   : public Theron::AMQ::NetworkLayer::AMQProperties
@@ -222,6 +328,7 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
   private:
 
     const std::string User, Password, ApplicationID;
+    const NebulOuS::FlowControlPolicy FlowControl;
 
   protected:
 
@@ -243,6 +350,10 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
     // well documented and the current implmenentation is based on the 
     // example for an earlier Proton version (0.32.0) and the example at
     // https://qpid.apache.org/releases/qpid-proton-0.32.0/proton/cpp/examples/selected_recv.cpp.html
+    // The flow control policy is applied to the options at the end. The 
+    // Theron++ network layer asks for the same receiver options for all 
+    // links, so the policy applies to every subscription, but the credit is
+    // given to each link separately.
 
     virtual proton::receiver_options ReceiverOptions( void ) const override
     {
@@ -266,7 +377,7 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
       TheSourceOptions.filters( TheFilter );
       TheOptions.source( TheSourceOptions );
 
-      return TheOptions;
+      return FlowControl.Apply( TheOptions );
     }
 
     // The application identifier must also be provided in every message to 
@@ -289,18 +400,30 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
   public:
 
     AMQOptions( const std::string & TheUser, const std::string & ThePassword,
-                const std::string & TheAppID )
-    : User( TheUser ), Password( ThePassword ), ApplicationID( TheAppID )
+                const std::string & TheAppID, 
+                const NebulOuS::FlowControlPolicy & ThePolicy )
+    : User( TheUser ), Password( ThePassword ), ApplicationID( TheAppID ),
+      FlowControl( ThePolicy )
     {}
 
     AMQOptions( const AMQOptions & Other )
     : User( Other.User ), Password( Other.Password ), 
-      ApplicationID( Other.ApplicationID )
+      ApplicationID( Other.ApplicationID ), FlowControl( Other.FlowControl )
     {}
 
     virtual ~AMQOptions() = default;
   };
 
+  // The flow control policy is given by the preset, possibly with an explicit
+  // credit window for the receiving links.
+
+  NebulOuS::FlowControlPolicy FlowControl( 
+    NebulOuS::FlowControlPolicy::ByName( 
+      CLIValues["FlowControl"].as<std::string>() ) );
+
+  if( CLIValues["Credit"].as<unsigned int>() > 0 )
+    FlowControl.CreditWindow = CLIValues["Credit"].as<unsigned int>();
+
   // --------------------------------------------------------------------------
   // AMQ communication
   // --------------------------------------------------------------------------
@@ -315,21 +438,25 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
   // Presentation layer servers, but calling the endpoint for "Solver" to make
   // it more visible at the AMQ broker listing of subscribers. The endpoint 
   // will be a unique application identifier. The server names are followed
-  // by the defined AMQ options.
-
-  Theron::AMQ::NetworkEndpoint AMQNetWork( 
-    CLIValues["Endpoint"].as< std::string >(), 
-    CLIValues["Broker"].as< std::string >(),
-    CLIValues["Port"].as< unsigned int >(),
-    CLIValues["Name"].as< std::string >(),
-    Theron::AMQ::Network::SessionLayerLabel,
-    Theron::AMQ::Network::PresentationLayerLabel,
-    std::make_shared< AMQOptions >(
-      CLIValues["User"].as< std::string >(),
-      CLIValues["Password"].as< std::string >(),
-      CLIValues["Endpoint"].as< std::string >()
-    )
-  );
+  // by the defined AMQ options. The network is not started in batch mode.
+
+  std::unique_ptr< Theron::AMQ::NetworkEndpoint > AMQNetWork;
+
+  if( !BatchMode )
+    AMQNetWork = std::make_unique< Theron::AMQ::NetworkEndpoint >( 
+      CLIValues["Endpoint"].as< std::string >(), 
+      CLIValues["Broker"].as< std::string >(),
+      CLIValues["Port"].as< unsigned int >(),
+      CLIValues["Name"].as< std::string >(),
+      Theron::AMQ::Network::SessionLayerLabel,
+      Theron::AMQ::Network::PresentationLayerLabel,
+      std::make_shared< AMQOptions >(
+        CLIValues["User"].as< std::string >(),
+        CLIValues["Password"].as< std::string >(),
+        CLIValues["Endpoint"].as< std::string >(),
+        FlowControl
+      )
+    );
 
   // --------------------------------------------------------------------------
   // Solver component actors
@@ -344,26 +471,83 @@ int main( int NumberOfCLIOptions, char ** CLIOptionStrings )
   // where n is a sequence number from 1.As all solvers are of the same type 
   // given by the template parameter (here AMPLSolver), they are assumed to need
   // the same set of constructor arguments and the constructor arguments follow
-  // the root solver name.
+  // the root solver name. The directory for the solution history comes before 
+  // the number of solvers, and the history is disabled if it is not given. 
+  // The keyframe interval for delta solutions follows the history directory.
+  // The manager does not subscribe to external contexts in batch mode.
 
   NebulOuS::SolverManager< NebulOuS::AMPLSolver > 
   WorkloadMabager( CLIValues["Name"].as<std::string>(), 
     NebulOuS::Solver::Solution::AMQTopic, 
-    NebulOuS::Solver::ApplicationExecutionContext::AMQTopic,
-    1, "AMPLSolver", 
+    BatchMode ? std::string() : std::string( 
+      NebulOuS::Solver::ApplicationExecutionContext::AMQTopic ),
+    std::filesystem::path( CLIValues["HistoryDir"].as<std::string>() ),
+    CLIValues["Keyframes"].as<unsigned int>(),
+    CLIValues["Surrogate"].as<double>(),
+    CLIValues["WarmStart"].as<bool>(),
+    CLIValues["TightenBounds"].as<bool>(),
+    CLIValues["Solvers"].as<unsigned int>(), "AMPLSolver", 
     ampl::Environment( TheAMPLDirectory.native() ), ModelDirectory, 
-    CLIValues["Solver"].as<std::string>() );
-
-  NebulOuS::MetricUpdater 
-  ContextMabager( "MetricUpdater", WorkloadMabager.GetAddress() );
+    CLIValues["Solver"].as<std::string>(), 
+    CLIValues["Enumerate"].as<std::size_t>() );
+
+  // In batch mode the Batch Runner, or the Training Set Generator, defines 
+  // the problem for the solvers and submits the contexts, and there is no 
+  // Metric Updater since there are no metric predictions.
+
+  std::unique_ptr< NebulOuS::MetricUpdater >        ContextMabager;
+  std::unique_ptr< NebulOuS::BatchRunner >          BatchSolutions;
+  std::unique_ptr< NebulOuS::TrainingSetGenerator > TrainingSet;
+
+  if( TrainingMode )
+    TrainingSet = std::make_unique< NebulOuS::TrainingSetGenerator >(
+      "TrainingSetGenerator", WorkloadMabager.GetAddress(), "AMPLSolver",
+      CLIValues["Solvers"].as<unsigned int>(),
+      std::filesystem::path( CLIValues["Model"].as<std::string>() ),
+      std::filesystem::path( CLIValues["Data"].as<std::string>() ),
+      CLIValues["Objective"].as<std::string>(),
+      NebulOuS::ContextSampler( 
+        NebulOuS::ContextSampler::ReadRanges( 
+          std::filesystem::path( CLIValues["Ranges"].as<std::string>() ) ),
+        NebulOuS::ContextSampler::ByName( 
+          CLIValues["Sampling"].as<std::string>() ),
+        CLIValues["Samples"].as<std::size_t>(),
+        CLIValues["Seed"].as<std::uint64_t>() ),
+      std::filesystem::path( CLIValues["TrainingSet"].as<std::string>() ) );
+  else if( BatchMode )
+    BatchSolutions = std::make_unique< NebulOuS::BatchRunner >( 
+      "BatchRunner", WorkloadMabager.GetAddress(), "AMPLSolver", 
+      CLIValues["Solvers"].as<unsigned int>(),
+      std::filesystem::path( CLIValues["Model"].as<std::string>() ),
+      std::filesystem::path( CLIValues["Data"].as<std::string>() ),
+      CLIValues["Objective"].as<std::string>(),
+      std::filesystem::path( CLIValues["Batch"].as<std::string>() ),
+      std::filesystem::path( CLIValues["Output"].as<std::string>() ) );
+  else
+    ContextMabager = std::make_unique< NebulOuS::MetricUpdater >( 
+      "MetricUpdater", WorkloadMabager.GetAddress(),
+      CLIValues["WildcardMetrics"].as<bool>(),
+      CLIValues["MetricShards"].as<unsigned int>() );
+
+  // Co-located clients may submit contexts directly to the Solver Manager 
+  // over a Unix domain socket if a path for the socket is given.
+
+  std::unique_ptr< NebulOuS::LocalQueryServer > LocalQueries;
+
+  if( !CLIValues["LocalSocket"].as<std::string>().empty() )
+    LocalQueries = std::make_unique< NebulOuS::LocalQueryServer >( 
+      "LocalQueryServer", 
+      std::filesystem::path( CLIValues["LocalSocket"].as<std::string>() ),
+      WorkloadMabager.GetAddress() );
 
   // --------------------------------------------------------------------------
   // Termination management
   // --------------------------------------------------------------------------
   //
   // The critical part is to wait for the global shut down message from the 
-  // Optimiser controller. That message will trigger the network to shut down
-  // and the Solver Component may terminate when the actor system has finished.
+  // Optimiser controller, or from the Batch Runner in batch mode. That message
+  // will trigger the network to shut down, and the Solver Component may 
+  // terminate when the actor system has finished.
   // Thus, the actors can still be running for some time after the global shut
   // down message has been received, and it is therefore necessary to also wait
   // for the actors to terminate.
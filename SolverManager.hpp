@@ -46,6 +46,8 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <string>                               // Normal strings
 #include <map>                                  // Multimap for the work queue
 #include <unordered_set>                        // Solver ready status
+#include <unordered_map>                        // Core allocations
+#include <thread>                               // Hardware concurrency
 #include <list>                                 // Pool of local solvers
 #include <ranges>                               // Range based views
 #include <algorithm>                            // Standard algorithms
@@ -56,6 +58,11 @@ License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
 #include <condition_variable>                   // Execution stop management
 #include <mutex>                                // Lock the condtion variable
 #include <tuple>                                // For constructing solvers
+#include <memory>                               // For the solution history
+#include <chrono>                               // Solve time measurements
+#include <filesystem>                           // History directory
+#include <cstdint>                              // Snapshot versions
+#include <optional>                             // Reply destinations
 
 // Other packages
 
@@ -67,6 +74,7 @@ using JSON = nlohmann::json;                    // Short form name space
 
 #include "Actor.hpp"                            // Actor base class
 #include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+#include "Utility/ConsolePrint.hpp"             // For logging
 #include "Communication/NetworkingActor.hpp"    // Networking actors
 
 // AMQ communication headers
@@ -78,6 +86,13 @@ using JSON = nlohmann::json;                    // Short form name space
 
 #include "ExecutionControl.hpp"                  // Shut down messages
 #include "Solver.hpp"                            // The basic solver class
+#include "SolutionHistory.hpp"                   // Solution records
+#include "SolutionSurrogate.hpp"                 // Predicted solutions
+#include "SolutionIndex.hpp"                     // Warm start solutions
+#include "VariableBoundLearner.hpp"              // Tightened bounds
+#include "SolutionPublisher.hpp"                 // Outbound solutions
+#include "MetricSnapshotStore.hpp"               // Shared metric values
+#include "Timer.hpp"                             // Batch window
 
 namespace NebulOuS
 {
@@ -114,6 +129,53 @@ private:
   std::list< SolverType >       SolverPool;
   std::unordered_set< Address > ActiveSolvers, PassiveSolvers;
 
+  // --------------------------------------------------------------------------
+  // Core budget
+  // --------------------------------------------------------------------------
+  //
+  // Multi-threaded back-end solvers will by default use all available cores,
+  // and running several solvers in parallel will therefore oversubscribe the 
+  // machine. The available cores are therefore split among the active solvers
+  // and each solver is told how many threads it may use before it receives 
+  // the application execution context. The cores allocated to a solver are
+  // returned to the budget when the solver returns its solution, so that a 
+  // solver starting when all other solvers are idle gets the whole machine.
+
+  const unsigned int AvailableCores;
+  unsigned int       AllocatedCores;
+  std::unordered_map< Address, unsigned int > CoreAllocation;
+
+  // The number of cores given to a solver is the fair share of the cores for
+  // the number of solvers that will be active after the dispatch, but it is
+  // limited by the number of cores not already allocated to running solvers.
+  // Every solver will have at least one core.
+
+  unsigned int AllocateCores( const Address & TheSolver, 
+                              const std::size_t ConcurrentSolvers )
+  {
+    unsigned int FairShare = AvailableCores / 
+                 std::max< std::size_t >( ConcurrentSolvers, 1 ),
+                 FreeCores = AvailableCores > AllocatedCores 
+                           ? AvailableCores - AllocatedCores : 0,
+                 TheShare  = std::max( std::min( FairShare, FreeCores ), 1u );
+
+    CoreAllocation[ TheSolver ] = TheShare;
+    AllocatedCores += TheShare;
+
+    return TheShare;
+  }
+
+  void ReleaseCores( const Address & TheSolver )
+  {
+    auto TheAllocation = CoreAllocation.find( TheSolver );
+
+    if( TheAllocation != CoreAllocation.end() )
+    {
+      AllocatedCores -= std::min( AllocatedCores, TheAllocation->second );
+      CoreAllocation.erase( TheAllocation );
+    }
+  }
+
   // --------------------------------------------------------------------------
   // Application Execution Context management
   // --------------------------------------------------------------------------
@@ -138,15 +200,28 @@ private:
   {
     if( !PassiveSolvers.empty() && !ContextQueue.empty() )
     {
-      for( const auto & [ SolverAddress, ContextElement ] : 
-           std::ranges::views::zip( PassiveSolvers, ContextQueue ) )
-        Send( ContextElement.second, SolverAddress );
-
       // The number of contexts dispatched must equal the minimum of the 
-      // available solvers and the available contexts.
+      // available solvers and the available contexts. The thread budget of 
+      // each solver depends on the total number of solvers running after 
+      // this dispatch, and it must be sent before the context.
 
       std::size_t DispatchedContexts 
-        = std::min( PassiveSolvers.size(), ContextQueue.size() );
+        = std::min( PassiveSolvers.size(), ContextQueue.size() ),
+                  ConcurrentSolvers = ActiveSolvers.size() + DispatchedContexts;
+
+      for( const auto & [ SolverAddress, ContextElement ] : 
+           std::ranges::views::zip( PassiveSolvers, ContextQueue ) )
+      {
+        Send( Solver::ThreadBudget( 
+              AllocateCores( SolverAddress, ConcurrentSolvers ) ), 
+              SolverAddress );
+        Send( SolverContext( ContextElement.second ), SolverAddress );
+
+        PendingSolutions.erase( SolverAddress );
+        PendingSolutions.emplace( SolverAddress, 
+          DispatchRecord{ ContextElement.second, 
+                          std::chrono::steady_clock::now() } );
+      }
 
       // Then move the passive solver addresses used to active solver addresses
 
@@ -166,37 +241,926 @@ private:
     }
   }
 
-  // The handler function simply enqueues the received context, records its 
-  // timesamp and dispatch as many contexts as possible to the solvers.
+  // The contexts being solved are remembered for each solver together with 
+  // the time the context was dispatched so that the solution can be recorded 
+  // with its context and the time it took to solve it.
+
+  struct DispatchRecord
+  {
+    Solver::ApplicationExecutionContext   Context;
+    std::chrono::steady_clock::time_point Started;
+  };
+
+  std::unordered_map< Address, DispatchRecord > PendingSolutions;
+
+  // --------------------------------------------------------------------------
+  // Context snapshots
+  // --------------------------------------------------------------------------
+  //
+  // A context may be sent as a delta context containing only the metrics that
+  // have changed relative to a base context received earlier. The metric 
+  // values of the most recent contexts are therefore kept by their context 
+  // identifier so that the delta contexts can be resolved before they are 
+  // queued. The number of snapshots kept is limited, and the oldest snapshot
+  // is forgotten when the limit is reached. The metric values are shared 
+  // with the Metric Snapshot Store for contexts referencing a snapshot.
+
+  static constexpr std::size_t MaxContextSnapshots = 64;
+
+  using SnapshotValues = std::shared_ptr< const Solver::MetricValueType >;
+
+  std::unordered_map< std::string, SnapshotValues > ContextSnapshots;
+  std::list< std::string > SnapshotOrder;
+  std::string              LatestSnapshot;
+
+  // The identifier of a context is the explicit context identifier, or the 
+  // correlation identifier, or the time stamp in that order of preference.
+  // A correlation identifier that is not a string is used in its JSON text
+  // form.
+
+  static std::string ContextIdentifier( 
+    const Solver::ApplicationExecutionContext::View & TheContext )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    if( TheContext.Has< Keys::ContextID >() )
+      return TheContext.Get< Keys::ContextID >();
+    else if( TheContext.Has< Keys::CorrelationID >() )
+    {
+      const JSON & TheCorrelation = TheContext.Get< Keys::CorrelationID >();
+
+      if( TheCorrelation.is_string() )
+        return TheCorrelation.get< std::string >();
+      else
+        return TheCorrelation.dump();
+    }
+    else
+      return std::to_string( TheContext.Get< Keys::TimeStamp >() );
+  }
+
+  // The context identifiers with the local reply prefix are reserved for the
+  // contexts of local actors, and an invalid argument exception is thrown if
+  // a context from a remote requester uses a reserved identifier. 
+
+  static void CheckContextIdentifier( 
+    const Solver::ApplicationExecutionContext::View & TheContext,
+    const Address & TheRequester )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    if( TheContext.Has< Keys::ContextID >() && 
+        TheContext.Get< Keys::ContextID >().starts_with( 
+          Solver::ApplicationExecutionContext::LocalReply ) &&
+        !TheRequester.IsLocalActor() )
+    {
+      std::source_location Location = std::source_location::current();
+      std::ostringstream ErrorMessage;
+
+      ErrorMessage << "[" << Location.file_name() << " at line " 
+                   << Location.line()
+                   << "in function " << Location.function_name() <<"] " 
+                   << "The context identifier [" 
+                   << TheContext.Get< Keys::ContextID >() 
+                   << "] is reserved for local actors and the context from "
+                   << TheRequester.AsString() << " is rejected";
+
+      throw std::invalid_argument( ErrorMessage.str() );
+    }
+  }
+
+  // Storing a snapshot moves the identifier to the end of the order list.
+
+  void StoreSnapshot( const std::string & TheIdentifier, 
+                      SnapshotValues TheValues )
+  {
+    if( ContextSnapshots.contains( TheIdentifier ) )
+      SnapshotOrder.remove( TheIdentifier );
+    else if( ContextSnapshots.size() >= MaxContextSnapshots )
+    {
+      ContextSnapshots.erase( SnapshotOrder.front() );
+      SnapshotOrder.pop_front();
+    }
+
+    ContextSnapshots.insert_or_assign( TheIdentifier, TheValues );
+    SnapshotOrder.push_back( TheIdentifier );
+    LatestSnapshot = TheIdentifier;
+  }
+
+  // A delta context is resolved by overwriting the metric values of the base 
+  // context with the changed values. The resolved context is a full context 
+  // without the base context reference. An invalid argument exception is 
+  // thrown if the base context is not known. The fields of the context are 
+  // read from the view of the context, and the resolved context shares the
+  // view unless it is changed.
+
+  Solver::ApplicationExecutionContext ResolveContext( 
+    const Solver::ApplicationExecutionContext & TheContext )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    const Solver::ApplicationExecutionContext::View & TheView 
+                                                    = TheContext.GetView();
+    Solver::ApplicationExecutionContext ResolvedContext( TheContext );
+
+    if( TheView.Has< Keys::BaseContext >() )
+    {
+      std::string TheBase = TheView.Get< Keys::BaseContext >();
+
+      if( TheBase == Solver::ApplicationExecutionContext::LatestContext )
+        TheBase = LatestSnapshot;
+
+      auto BaseSnapshot = ContextSnapshots.find( TheBase );
+
+      if( BaseSnapshot == ContextSnapshots.end() )
+      {
+        std::source_location Location = std::source_location::current();
+        std::ostringstream ErrorMessage;
+
+        ErrorMessage << "[" << Location.file_name() << " at line " 
+                     << Location.line()
+                     << "in function " << Location.function_name() <<"] " 
+                     << "The base context [" << TheBase << "] of the delta "
+                     << "context is unknown: " << TheContext.dump(2);
+
+        throw std::invalid_argument( ErrorMessage.str() );
+      }
+
+      auto MetricValues = std::make_shared< Solver::MetricValueType >( 
+                            *BaseSnapshot->second );
+
+      for( const auto & [ TheMetric, TheValue ] : 
+           TheView.Value< Keys::ExecutionContext >( Solver::MetricValueType() ) )
+        MetricValues->insert_or_assign( TheMetric, TheValue );
+
+      ResolvedContext.Set< Keys::ExecutionContext >( *MetricValues );
+      ResolvedContext.Erase< Keys::BaseContext >();
+
+      StoreSnapshot( ContextIdentifier( TheView ), MetricValues );
+    }
+    else if( MetricSnapshotStore::ReferencesSnapshot( TheView ) )
+    {
+      // The context refers to a snapshot of the metric values that is shared
+      // without copying the values, and the context is passed on unchanged.
+
+      auto TheSnapshot = MetricSnapshotStore::Shared().Referenced( TheView );
+
+      StoreSnapshot( ContextIdentifier( TheView ), 
+        SnapshotValues( TheSnapshot, &TheSnapshot->MetricValues ) );
+    }
+    else
+      StoreSnapshot( ContextIdentifier( TheView ), 
+        std::make_shared< const Solver::MetricValueType >( 
+          TheView.Get< Keys::ExecutionContext >() ) );
+
+    return ResolvedContext;
+  }
+
+  // The metric values of a context are found in the context, or in the 
+  // snapshot it refers to. No metric values are returned if the snapshot has
+  // already been overwritten.
+
+  static std::optional< Solver::MetricValueType > ContextMetrics( 
+    const Solver::ApplicationExecutionContext & TheContext )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    const Solver::ApplicationExecutionContext::View & TheView 
+                                                    = TheContext.GetView();
+
+    if( MetricSnapshotStore::ReferencesSnapshot( TheView ) )
+    {
+      if( auto TheSnapshot = MetricSnapshotStore::Shared().Find( 
+            TheView.Get< Keys::SnapshotVersion >() ) )
+        return TheSnapshot->MetricValues;
+      else
+        return std::nullopt;
+    }
+    else
+      return TheView.Value< Keys::ExecutionContext >( 
+                                               Solver::MetricValueType() );
+  }
+
+  // The handler function validates the context through its view, resolves 
+  // the context if it is a delta context, publishes a predicted solution if the 
+  // requester accepts an approximate solution, then enqueues the context, 
+  // records its timesamp and dispatch as many contexts as possible to the 
+  // solvers. The context is solved exactly also when a predicted solution
+  // has been published in order to verify the prediction. 
+  //
+  // The local reply prefix is only honoured for contexts submitted by local
+  // actors, and it is removed from the reply address of a remote context so
+  // that a remote requester cannot have its solutions delivered to a local 
+  // actor. A context that cannot be accepted is answered with a failed 
+  // solution giving the reason.
 
   void HandleApplicationExecutionContext( 
     const Solver:: ApplicationExecutionContext & TheContext,
     const Address TheRequester )
   {
-    ContextQueue.emplace( 
-      TheContext.at( Solver::ApplicationExecutionContext::Keys::TimeStamp 
-                   ).get< Solver::TimePointType >(), 
-      TheContext );
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    bool RemoteLocalReply = !TheRequester.IsLocalActor() && 
+      TheContext.contains( Keys::ReplyTo ) && 
+      TheContext.at( Keys::ReplyTo ).is_string() &&
+      TheContext.at( Keys::ReplyTo ).get< std::string >().starts_with( 
+        Solver::ApplicationExecutionContext::LocalReply );
+
+    try
+    {
+      const Solver::ApplicationExecutionContext::View & TheView 
+                                                      = TheContext.GetView();
+
+      CheckContextIdentifier( TheView, TheRequester );
+
+      // The encoding of the context is remembered for its reply topic so that
+      // the solution can be returned in the same encoding.
+
+      if( TheView.Has< Keys::ReplyTo >() && 
+          !TheView.Get< Keys::ReplyTo >().empty() &&
+          !TheView.Get< Keys::ReplyTo >().starts_with( 
+            Solver::ApplicationExecutionContext::LocalReply ) )
+        ReplyDestination( TheView.Get< Keys::ReplyTo >(), 
+                          TheContext.GetEncoding() );
+
+      Solver::ApplicationExecutionContext 
+        ResolvedContext( ResolveContext( TheContext ) );
+
+      if( RemoteLocalReply )
+        ResolvedContext.Erase< Keys::ReplyTo >();
+
+      if( Surrogate && TheView.Value< Keys::Approximate >( false ) && 
+         !TheView.Value< Keys::DeploymentFlag >( false ) &&
+         !TheView.Has< Keys::Candidates >() )
+        PredictSolution( ResolvedContext, ResolvedContext.GetView() );
+
+      ContextQueue.emplace( TheView.Get< Keys::TimeStamp >(), 
+                            std::move( ResolvedContext ) );
+    }
+    catch( const std::exception & TheError )
+    {
+      Solver::Solution Failure( TheContext, TheError.what() );
+
+      if( RemoteLocalReply )
+        Failure.erase( Keys::ReplyTo );
+
+      DeliverFailure( Failure );
+    }
 
     DispatchToSolvers();
   }
 
   // --------------------------------------------------------------------------
-  // Solutions
+  // Solution destinations
   // --------------------------------------------------------------------------
   //
-  // When a solution is received from a solver, it will be dispatched to all
-  // entities subscribing to the solution topic, and the solver will be returned
-  // to the pool of passive solvers. The dispatch function will be called at the 
-  // end to ensure that the solver starts working on queued application execution
-  // contexts, if any.
+  // The solutions are published by the Solution Publisher actor so that the
+  // manager does not wait for the network.
+
+  SolutionPublisher Publisher;
+
+  // A solution for a context with a reply topic is sent only to this topic. 
+  // A publisher is created for a reply topic the first time it is used, and 
+  // it is kept open for future replies to the same requester. The number of
+  // open reply publishers is bounded, and the publisher of the reply topic 
+  // least recently used is closed when a new reply topic would exceed the 
+  // bound. A reply topic outside of the NebulOuS topic name space is not 
+  // accepted, and no destination is returned for it. 
+  //
+  // The replies are encoded in the format the requester used for its last 
+  // request with the reply topic, while the messages on the shared topics 
+  // are always text JSON. There are no reply topics without a network.
+
+  static constexpr std::size_t MaxReplyTopics = 64;
+
+  struct ReplyTopic
+  {
+    std::list< Theron::AMQ::TopicName >::iterator Position;
+    MessageEncoding::Format                       Encoding;
+  };
+
+  std::list< Theron::AMQ::TopicName > ReplyTopics;
+  std::unordered_map< Theron::AMQ::TopicName, ReplyTopic > ReplyTopicIndex;
+
+  std::optional< Address > ReplyDestination( 
+    const Theron::AMQ::TopicName & TheReplyTopic,
+    std::optional< MessageEncoding::Format > TheEncoding = std::nullopt )
+  {
+    if( !HasNetwork() ) return std::nullopt;
+
+    if( !TheReplyTopic.starts_with( 
+          Solver::ApplicationExecutionContext::ReplyTopicPrefix ) )
+    {
+      Theron::ConsoleOutput Output;
+      Output << "Solver Manager: The reply topic [" << TheReplyTopic 
+             << "] is not a NebulOuS topic and it is ignored" << std::endl;
+
+      return std::nullopt;
+    }
+
+    if( auto TheTopic = ReplyTopicIndex.find( TheReplyTopic ); 
+        TheTopic != ReplyTopicIndex.end() )
+    {
+      ReplyTopics.splice( ReplyTopics.end(), ReplyTopics, 
+                          TheTopic->second.Position );
+
+      if( TheEncoding ) TheTopic->second.Encoding = *TheEncoding;
+    }
+    else
+    {
+      if( ReplyTopics.size() >= MaxReplyTopics )
+      {
+        Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+              Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher, 
+              ReplyTopics.front() ), GetSessionLayerAddress() );
+
+        ReplyTopicIndex.erase( ReplyTopics.front() );
+        ReplyTopics.pop_front();
+      }
+
+      Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+            Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher, 
+            TheReplyTopic ), GetSessionLayerAddress() );
+
+      ReplyTopicIndex.emplace( TheReplyTopic, ReplyTopic{ 
+        ReplyTopics.insert( ReplyTopics.end(), TheReplyTopic ),
+        TheEncoding.value_or( MessageEncoding::Format::JSON ) } );
+    }
+
+    return Address( TheReplyTopic );
+  }
+
+  // The encoding of the messages to a destination is text JSON unless the 
+  // destination is a reply topic.
+
+  MessageEncoding::Format ReplyEncoding( const Address & TheDestination ) const
+  {
+    auto TheTopic = ReplyTopicIndex.find( TheDestination.AsString() );
+
+    if( TheTopic != ReplyTopicIndex.end() )
+      return TheTopic->second.Encoding;
+    else
+      return MessageEncoding::Format::JSON;
+  }
+
+  // A local reply is sent directly to the named actor, and solutions without
+  // a valid reply topic are published on the general solution topic.
+
+  Address SolutionDestination( const Solver::Solution & TheSolution )
+  {
+    if( TheSolution.contains( Solver::Solution::Keys::ReplyTo ) )
+    {
+      Theron::AMQ::TopicName TheReplyTopic = TheSolution.at( 
+        Solver::Solution::Keys::ReplyTo ).get< Theron::AMQ::TopicName >();
+
+      if( TheReplyTopic.starts_with( 
+            Solver::ApplicationExecutionContext::LocalReply ) )
+      {
+        std::string TheActor = TheReplyTopic.substr( 
+          Solver::ApplicationExecutionContext::LocalReply.size() );
+
+        return Address( TheActor.substr( 0, TheActor.find( '#' ) ) );
+      }
+      else if( !TheReplyTopic.empty() )
+        if( auto TheDestination = ReplyDestination( TheReplyTopic ) )
+          return *TheDestination;
+    }
+
+    return Address( SolutionReceiver );
+  }
+
+  // --------------------------------------------------------------------------
+  // Delta solutions
+  // --------------------------------------------------------------------------
+  //
+  // Solutions for large models have many variables, and often only a few of 
+  // them change from one solution to the next. If the keyframe interval is 
+  // larger than zero, solutions that are not to be deployed are published 
+  // with only the variables that changed relative to the previous solution 
+  // published to the same destination for the same objective function. Every
+  // keyframe interval solution is published in full so that a receiver that
+  // has missed a solution can resynchronise. A full solution is also sent if 
+  // the model or the set of variables has changed. Deployable solutions,
+  // evaluations of candidates, and local replies are always published in 
+  // full, and they do not change the stream. The local requesters, like the
+  // Batch Runner and the Training Set Generator, write each solution on its
+  // own and cannot resolve delta solutions. All published solutions are 
+  // given a solution identifier. The stream of a solution is identified by 
+  // its reply address.
+  //
+  // The solution identifiers are counted from the time the manager started
+  // in microseconds since the POSIX epoch so that the identifiers of a new 
+  // run of the Solver Component do not repeat the identifiers of the 
+  // previous run. The number of streams is bounded, and the stream least 
+  // recently used is forgotten when a new stream would exceed the bound. 
+  // The next solution for a forgotten stream is published in full.
+
+  static constexpr std::size_t MaxSolutionStreams = 256;
+
+  const unsigned int KeyframeInterval;
+  std::uint64_t      SolutionCounter;
+
+  struct SolutionStream
+  {
+    std::uint64_t                      LastSolution;
+    JSON                               ModelVersion, Variables;
+    unsigned int                       SinceKeyframe;
+    std::list< std::string >::iterator Position;
+  };
+
+  std::unordered_map< std::string, SolutionStream > SolutionStreams;
+  std::list< std::string >                           StreamOrder;
+
+  Solver::Solution EncodeSolution( const Solver::Solution & TheSolution, 
+                                   const Address & TheDestination )
+  {
+    using Keys = Solver::Solution::Keys;
+
+    Solver::Solution Encoded( TheSolution );
+    Encoded[ Keys::SolutionID ] = ++SolutionCounter;
+
+    if( ( KeyframeInterval == 0 ) || 
+        TheSolution.value( Keys::DeploymentFlag, false ) ||
+        TheSolution.contains( Keys::CandidateEvaluations ) ||
+        TheSolution.value( Keys::ReplyTo, std::string() ).starts_with( 
+          Solver::ApplicationExecutionContext::LocalReply ) )
+      return Encoded;
+
+    std::string StreamKey = 
+      TheSolution.value( Keys::ReplyTo, TheDestination.AsString() ) + "/" 
+      + TheSolution.value( Keys::ObjectiveFunctionLabel, std::string() );
+
+    const JSON & Variables  = TheSolution.at( Keys::VariableValues );
+    JSON         TheVersion = TheSolution.value( Keys::ModelVersion, JSON() );
+
+    auto Known = SolutionStreams.find( StreamKey );
+
+    if( Known == SolutionStreams.end() )
+    {
+      if( SolutionStreams.size() >= MaxSolutionStreams )
+      {
+        SolutionStreams.erase( StreamOrder.front() );
+        StreamOrder.pop_front();
+      }
+
+      SolutionStreams.emplace( StreamKey, SolutionStream{ SolutionCounter, 
+        TheVersion, Variables, 0, 
+        StreamOrder.insert( StreamOrder.end(), StreamKey ) } );
+
+      return Encoded;
+    }
+
+    SolutionStream & Stream = Known->second;
+    StreamOrder.splice( StreamOrder.end(), StreamOrder, Stream.Position );
+
+    // The changed variables are found if the stream should continue with a 
+    // delta solution. The set of variables must be the same as for the 
+    // previous solution for a delta to be possible.
+
+    JSON Changes = JSON::object();
+    bool Keyframe = ( ++Stream.SinceKeyframe >= KeyframeInterval ) || 
+                    ( TheVersion != Stream.ModelVersion ) ||
+                    ( Variables.size() != Stream.Variables.size() );
+
+    for( auto TheVariable = Variables.begin(); 
+         !Keyframe && ( TheVariable != Variables.end() ); ++TheVariable )
+    {
+      auto Previous = Stream.Variables.find( TheVariable.key() );
+
+      if( Previous == Stream.Variables.end() )
+        Keyframe = true;
+      else if( *Previous != TheVariable.value() )
+        Changes[ TheVariable.key() ] = TheVariable.value();
+    }
+
+    if( !Keyframe )
+    {
+      Encoded[ Keys::VariableValues ] = Changes;
+      Encoded[ Keys::BaseSolution   ] = Stream.LastSolution;
+    }
+    else
+      Stream.SinceKeyframe = 0;
+
+    Stream.LastSolution = SolutionCounter;
+    Stream.ModelVersion = TheVersion;
+    Stream.Variables    = Variables;
+
+    return Encoded;
+  }
+
+  // --------------------------------------------------------------------------
+  // Solution batches
+  // --------------------------------------------------------------------------
+  //
+  // A requester submitting many contexts, for instance for a simulation, can 
+  // ask for its solutions to be batched by setting the batch flag in the 
+  // contexts with a reply address. The solutions are then collected per 
+  // destination and published as one message when the batch is full, or 
+  // when the oldest solution in the batch has waited longer than the batch 
+  // window. The batches are checked when a solution arrives and when the 
+  // batch timer expires, which it does every batch window while there are 
+  // pending batches. All batches are published when the solvers become idle
+  // so that no solution is held back when there are no more contexts to 
+  // solve. Deployable solutions and solutions for the shared solution topic
+  // are never batched.
+
+  static constexpr std::size_t MaxBatchSize = 100;
+  static constexpr std::chrono::milliseconds BatchWindow{ 500 };
+
+  struct PendingBatch
+  {
+    Address                               Destination;
+    JSON                                  Solutions;
+    std::chrono::steady_clock::time_point Started;
+  };
+
+  std::unordered_map< std::string, PendingBatch > SolutionBatches;
+
+  Timer BatchTimer;
+  bool  BatchTimerArmed;
+
+  void ArmBatchTimer( void )
+  {
+    if( !BatchTimerArmed && !SolutionBatches.empty() )
+    {
+      Send( Timer::WakeUp( BatchWindow ), BatchTimer.GetAddress() );
+      BatchTimerArmed = true;
+    }
+  }
+
+  void BatchTimeout( const Timer::Timeout & TheTimeout, 
+                     const Address TheTimer )
+  {
+    BatchTimerArmed = false;
+    FlushBatches( ActiveSolvers.empty() );
+    ArmBatchTimer();
+  }
+
+  void SendBatch( const PendingBatch & TheBatch )
+  {
+    Solver::SolutionBatch TheMessage( TheBatch.Solutions );
+
+    TheMessage.SetEncoding( ReplyEncoding( TheBatch.Destination ) );
+    Send( SolutionPublisher::Publication< Solver::SolutionBatch >( 
+          TheMessage, TheBatch.Destination ), Publisher.GetAddress() );
+  }
+
+  void FlushBatches( bool AllBatches )
+  {
+    auto Now = std::chrono::steady_clock::now();
+
+    for( auto TheBatch = SolutionBatches.begin(); 
+         TheBatch != SolutionBatches.end(); )
+      if( AllBatches || ( Now - TheBatch->second.Started >= BatchWindow ) )
+      {
+        SendBatch( TheBatch->second );
+        TheBatch = SolutionBatches.erase( TheBatch );
+      }
+      else
+        ++TheBatch;
+  }
+
+  void BatchSolution( const Solver::Solution & TheSolution, 
+                      const Address & TheDestination )
+  {
+    auto [ TheBatch, NewBatch ] = SolutionBatches.try_emplace( 
+      TheDestination.AsString(), PendingBatch{ TheDestination, 
+      JSON::array(), std::chrono::steady_clock::now() } );
+
+    TheBatch->second.Solutions.push_back( TheSolution );
+
+    if( TheBatch->second.Solutions.size() >= MaxBatchSize )
+    {
+      SendBatch( TheBatch->second );
+      SolutionBatches.erase( TheBatch );
+    }
+    else
+      ArmBatchTimer();
+  }
+
+  // --------------------------------------------------------------------------
+  // Publishing solutions
+  // --------------------------------------------------------------------------
+  //
+  // When a solution is received from a solver, the solver will be returned 
+  // to the pool of passive solvers, and its cores returned to the core budget.
+  // The dispatch function will be called before the solution is published to
+  // ensure that the solver starts working on queued application execution 
+  // contexts, if any. The solution is then encoded for its destination and 
+  // either handed to the publisher or added to the batch of its destination. 
+  // Predicted solutions are delivered in the same way, but they are not 
+  // returned by a solver.
 
   void PublishSolution( const Solver::Solution & TheSolution, 
                         const Address TheSolver )
   {
-    Send( TheSolution, Address( SolutionReceiver ) );
+    RecordSolution( TheSolution, TheSolver );
+    ReleaseCores( TheSolver );
     PassiveSolvers.insert( ActiveSolvers.extract( TheSolver ) );
     DispatchToSolvers();
+
+    if( TheSolution.contains( Solver::Solution::Keys::Error ) )
+      DeliverFailure( TheSolution );
+    else
+      DeliverSolution( TheSolution );
+  }
+
+  // A failed solution is reported on the console and returned in full to the
+  // reply address of the requester. It is never batched, and it is not 
+  // published on the shared solution topic since the receivers of this topic
+  // expect solutions to deploy.
+
+  void DeliverFailure( const Solver::Solution & TheFailure )
+  {
+    Address TheDestination = SolutionDestination( TheFailure );
+
+    Theron::ConsoleOutput Output;
+    Output << "Solver Manager: No solution for the context with correlation "
+           << "identifier " 
+           << TheFailure.value( Solver::Solution::Keys::CorrelationID, JSON() )
+           << ": " << TheFailure.at( Solver::Solution::Keys::Error )
+           << std::endl;
+
+    if( !( TheDestination == Address( SolutionReceiver ) ) )
+    {
+      Solver::Solution Encoded( TheFailure );
+      Encoded.SetEncoding( ReplyEncoding( TheDestination ) );
+
+      Send( SolutionPublisher::Publication< Solver::Solution >( 
+            Encoded, TheDestination ), Publisher.GetAddress() );
+    }
+  }
+
+  void DeliverSolution( const Solver::Solution & TheSolution )
+  {
+    using Keys = Solver::Solution::Keys;
+
+    Address TheDestination = SolutionDestination( TheSolution );
+
+    // The shared solution topic does not exist in batch mode
+
+    if( !HasNetwork() && ( TheDestination == Address( SolutionReceiver ) ) )
+      return;
+
+    Solver::Solution Encoded = EncodeSolution( TheSolution, TheDestination );
+
+    Encoded.SetEncoding( ReplyEncoding( TheDestination ) );
+
+    if( TheSolution.value( Keys::BatchSolution,  false ) && 
+       !TheSolution.value( Keys::DeploymentFlag, false ) &&
+       !( TheDestination == Address( SolutionReceiver ) ) )
+      BatchSolution( Encoded, TheDestination );
+    else
+      Send( SolutionPublisher::Publication< Solver::Solution >( 
+            Encoded, TheDestination ), Publisher.GetAddress() );
+
+    FlushBatches( ActiveSolvers.empty() );
+  }
+
+  // --------------------------------------------------------------------------
+  // Solution history
+  // --------------------------------------------------------------------------
+  //
+  // If a directory for the solution history is given to the constructor, all
+  // solutions will be recorded together with the context they solve and the 
+  // time used to find the solution.
+
+  std::unique_ptr< SolutionHistory > History;
+
+  void RecordSolution( const Solver::Solution & TheSolution, 
+                       const Address TheSolver )
+  {
+    auto TheDispatch = PendingSolutions.find( TheSolver );
+
+    // Evaluations of candidate configurations and failed solutions are not 
+    // solutions and they are neither recorded nor learned. A prediction made
+    // for a context that failed cannot be verified, and it is forgotten.
+
+    if( ( TheSolution.contains( Solver::Solution::Keys::CandidateEvaluations ) 
+          || TheSolution.contains( Solver::Solution::Keys::Error ) ) &&
+        ( TheDispatch != PendingSolutions.end() ) )
+    {
+      Predictions.erase( 
+        ContextIdentifier( TheDispatch->second.Context.GetView() ) );
+      PendingSolutions.erase( TheDispatch );
+    }
+    else if( TheDispatch != PendingSolutions.end() )
+    {
+      // The history must store the metric values of contexts that refer
+      // to a snapshot since the snapshot will be overwritten later, and the 
+      // surrogate learns from the metric values. The solution is neither 
+      // recorded nor learned if the snapshot has already been overwritten 
+      // since it cannot be related to the metric values it solves.
+
+      using Keys = Solver::ApplicationExecutionContext::Keys;
+      Solver::ApplicationExecutionContext & TheContext 
+                                          = TheDispatch->second.Context;
+      bool MetricsKnown = true;
+
+      if( ( History || Surrogate || WarmStarts ) && 
+          MetricSnapshotStore::ReferencesSnapshot( TheContext.GetView() ) )
+      {
+        if( auto TheMetrics = ContextMetrics( TheContext ) )
+          TheContext.Set< Keys::ExecutionContext >( *TheMetrics );
+        else
+        {
+          MetricsKnown = false;
+
+          Theron::ConsoleOutput Output;
+          Output << "Solver Manager: The metric snapshot "
+                 << TheContext.at( Keys::SnapshotVersion ) 
+                 << " was overwritten before the solution was recorded, and "
+                 << "the solution is not recorded" << std::endl;
+        }
+      }
+
+      if( History && MetricsKnown )
+        History->Append( TheContext, TheSolution, 
+          std::chrono::duration_cast< std::chrono::microseconds >( 
+            std::chrono::steady_clock::now() - TheDispatch->second.Started 
+          ).count() );
+
+      if( Surrogate && MetricsKnown )
+        LearnSolution( TheContext, TheSolution );
+      else if( Surrogate )
+        Predictions.erase( ContextIdentifier( TheContext.GetView() ) );
+
+      if( WarmStarts && MetricsKnown )
+        WarmStarts->Insert( TheContext.GetView().Value< Keys::ExecutionContext >( 
+                              Solver::MetricValueType() ),
+          TheContext.GetView().Value< Keys::ObjectiveFunctionLabel >( 
+                              std::string() ),
+          TheSolution );
+
+      if( BoundLearner )
+        BoundLearner->Learn( TheSolution );
+
+      PendingSolutions.erase( TheDispatch );
+    }
+  }
+
+  // Queries to the history are answered on the reply topic of the query if
+  // it has a valid reply topic, and otherwise on the history response topic.
+  // A query that cannot be answered gets a response with the error message.
+
+  void HandleHistoryQuery( const SolutionHistory::Query & TheQuery, 
+                           const Address TheRequester )
+  {
+    if( History )
+    {
+      std::optional< Address > TheReplyTopic;
+
+      if( TheQuery.contains( SolutionHistory::Query::Keys::ReplyTo ) &&
+          TheQuery.at( SolutionHistory::Query::Keys::ReplyTo ).is_string() )
+        TheReplyTopic = ReplyDestination( 
+          TheQuery.at( SolutionHistory::Query::Keys::ReplyTo )
+                  .get< Theron::AMQ::TopicName >() );
+
+      const Address TheDestination( TheReplyTopic.value_or( 
+        Address( SolutionHistory::Response::AMQTopic ) ) );
+
+      // The response to a reply topic uses the encoding of the query, and 
+      // the response on the shared response topic is text JSON.
+
+      auto Respond = [&]( SolutionHistory::Response && TheResponse ){
+        if( TheReplyTopic ) TheResponse.SetEncoding( TheQuery.GetEncoding() );
+        Send( TheResponse, TheDestination );
+      };
+
+      try
+      {
+        Respond( SolutionHistory::Response( TheQuery, 
+                                            History->Answer( TheQuery ) ) );
+      }
+      catch( const std::exception & TheError )
+      {
+        Respond( SolutionHistory::Response( TheQuery, 
+                                            std::string( TheError.what() ) ) );
+      }
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // Solution surrogate
+  // --------------------------------------------------------------------------
+  //
+  // If a confidence threshold is given to the constructor, the solutions are
+  // learned by the surrogate, and a context asking for an approximate 
+  // solution gets a predicted solution at once if the surrogate has a trusted
+  // prediction. The predicted variable values are remembered by the context
+  // identifier until the exact solution verifies the prediction. Predictions 
+  // are also verified when the surrogate is not trusted so that the trust 
+  // can be regained.
+
+  std::unique_ptr< SolutionSurrogate > Surrogate;
+  std::unordered_map< std::string, Solver::MetricValueType > Predictions;
+
+  // The predicted solution carries the same routing fields as the exact 
+  // solution returned by a solver, and it is marked as predicted.
+
+  void PredictSolution( 
+    const Solver::ApplicationExecutionContext & TheContext,
+    const Solver::ApplicationExecutionContext::View & TheView )
+  {
+    using Keys = Solver::Solution::Keys;
+
+    auto TheMetrics = ContextMetrics( TheContext );
+
+    if( !TheMetrics ) return;
+
+    auto ThePrediction = Surrogate->Predict( *TheMetrics, 
+      TheView.Value< Keys::ObjectiveFunctionLabel >( std::string() ) );
+
+    if( !ThePrediction ) return;
+
+    Predictions.insert_or_assign( ContextIdentifier( TheView ), 
+                                  ThePrediction->VariableValues );
+
+    if( !Surrogate->Trusted() ) return;
+
+    Solver::Solution Predicted( TheView.Get< Keys::TimeStamp >(), 
+      TheView.Value< Keys::ObjectiveFunctionLabel >( std::string() ),
+      ThePrediction->ObjectiveValues, ThePrediction->VariableValues, false );
+
+    Predicted[ Keys::Predicted  ] = true;
+    Predicted[ Keys::Confidence ] = ThePrediction->Confidence;
+
+    if( TheView.Has< Keys::CorrelationID >() )
+      Predicted[ Keys::CorrelationID ] = TheView.Get< Keys::CorrelationID >();
+
+    if( TheView.Has< Keys::ReplyTo >() )
+      Predicted[ Keys::ReplyTo ] = TheView.Get< Keys::ReplyTo >();
+
+    if( TheView.Value< Keys::BatchSolution >( false ) )
+      Predicted[ Keys::BatchSolution ] = true;
+
+    DeliverSolution( Predicted );
+  }
+
+  // The exact solution is learned with the metric values and the objective
+  // label of the context, and it verifies the prediction made for the 
+  // context, if any.
+
+  void LearnSolution( const Solver::ApplicationExecutionContext & TheContext, 
+                      const Solver::Solution & TheSolution )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    const Solver::ApplicationExecutionContext::View & TheView 
+                                                    = TheContext.GetView();
+    auto ThePrediction = Predictions.find( ContextIdentifier( TheView ) );
+
+    if( ThePrediction != Predictions.end() )
+    {
+      Surrogate->Verify( ThePrediction->second, TheSolution );
+      Predictions.erase( ThePrediction );
+    }
+
+    Surrogate->Learn( TheView.Value< Keys::ExecutionContext >( 
+                        Solver::MetricValueType() ),
+                      TheView.Value< Keys::ObjectiveFunctionLabel >( 
+                        std::string() ), TheSolution );
+  }
+
+  // --------------------------------------------------------------------------
+  // Solver hints
+  // --------------------------------------------------------------------------
+  //
+  // If warm starts are enabled, the solutions are indexed by the metric values
+  // of their contexts, and a context is sent to the solver with the variable
+  // values of the solution for the nearest context already solved as the 
+  // starting point. 
+
+  std::unique_ptr< SolutionIndex > WarmStarts;
+
+  // If bound tightening is enabled, the ranges of the optimal variable values
+  // are learned from the solutions, and the context is sent to the solver 
+  // with the tightened bounds once enough solutions have been seen.
+
+  std::unique_ptr< VariableBoundLearner > BoundLearner;
+
+  // The hints are added to a copy of the context sent to the solver, and 
+  // hints given by the requester are kept.
+
+  Solver::ApplicationExecutionContext SolverContext( 
+    const Solver::ApplicationExecutionContext & TheContext )
+  {
+    using Keys = Solver::ApplicationExecutionContext::Keys;
+
+    const Solver::ApplicationExecutionContext::View & TheView 
+                                                    = TheContext.GetView();
+    Solver::ApplicationExecutionContext Hinted( TheContext );
+
+    if( WarmStarts && !TheView.Has< Keys::WarmStart >() )
+      if( auto TheMetrics = ContextMetrics( TheContext ) )
+        if( auto TheStart = WarmStarts->Nearest( *TheMetrics,
+              TheView.Value< Keys::ObjectiveFunctionLabel >( std::string() ) ) )
+          Hinted.Set< Keys::WarmStart >( *TheStart );
+
+    if( BoundLearner && !TheView.Has< Keys::VariableBounds >() )
+      if( auto TheBounds = BoundLearner->Bounds(); !TheBounds.empty() )
+        Hinted.Set< Keys::VariableBounds >( TheBounds );
+
+    return Hinted;
   }
 
   // --------------------------------------------------------------------------
@@ -211,6 +1175,13 @@ private:
   // system node as the manager.The final arguments to the constructor is a 
   // set of arguments to the solver type in the order expected by the solver
   // type and repeated for the number of (local) solvers that should be created.
+  // The directory for the solution history is given before the number of 
+  // solvers, and no history is kept if this is empty. It is followed by the 
+  // keyframe interval for delta solutions, and solutions are always sent in 
+  // full if this is zero. Then follows the confidence threshold for predicted
+  // solutions, and there is no solution surrogate if this is zero, and the 
+  // flag enabling warm starts from the solutions of the nearest contexts, 
+  // and the flag enabling bounds tightened from the solutions found.
   //
   // Currently this manager does not support dispatching configurations to
   // remote solvers and collect responses from these. However, this can be 
@@ -223,6 +1194,11 @@ public:
   SolverManager( const std::string & TheActorName, 
                  const Theron::AMQ::TopicName & SolutionTopic,
                  const Theron::AMQ::TopicName & ContextPublisherTopic,
+                 const std::filesystem::path & HistoryDirectory,
+                 const unsigned int SolutionKeyframes,
+                 const double SurrogateConfidence,
+                 const bool WarmStart,
+                 const bool TightenBounds,
                  const unsigned int NumberOfSolvers,
                  const std::string SolverRootName,
                  SolverArgTypes && ...SolverArguments )
@@ -233,7 +1209,18 @@ public:
     SolutionReceiver( SolutionTopic ),
     ContextTopic( ContextPublisherTopic ),
     SolverPool(), ActiveSolvers(), PassiveSolvers(),
-    ContextQueue()
+    AvailableCores( std::max( std::thread::hardware_concurrency(), 1u ) ),
+    AllocatedCores( 0 ), CoreAllocation(),
+    ContextQueue(), PendingSolutions(), 
+    ContextSnapshots(), SnapshotOrder(), LatestSnapshot(),
+    Publisher( TheActorName + "_Publisher" ), 
+    ReplyTopics(), ReplyTopicIndex(), 
+    KeyframeInterval( SolutionKeyframes ), 
+    SolutionCounter( std::chrono::duration_cast< std::chrono::microseconds >( 
+      std::chrono::system_clock::now().time_since_epoch() ).count() ),
+    SolutionStreams(), StreamOrder(), SolutionBatches(),
+    BatchTimer( TheActorName + "_BatchTimer" ), BatchTimerArmed( false ), 
+    History(), Surrogate(), Predictions(), WarmStarts(), BoundLearner()
   {
     // The solvers are created by expanding the arguments for the solvers 
     // one by one creating new elements in the solver pool. The solvers 
@@ -264,14 +1251,45 @@ public:
         std::inserter( PassiveSolvers, PassiveSolvers.end() ),
         [](const SolverType & TheSolver){ return TheSolver.GetAddress(); } );
 
-      Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
-            Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher, 
-            SolutionTopic ), GetSessionLayerAddress() );
+      // The topics are only opened if there is a network, and in batch mode
+      // the solutions are only returned to the local requesters.
 
-      if( !ContextPublisherTopic.empty() )
+      if( HasNetwork() )
+      {
         Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
-              Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription, 
-              ContextPublisherTopic ), GetSessionLayerAddress() );
+              Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher, 
+              SolutionTopic ), GetSessionLayerAddress() );
+
+        if( !ContextPublisherTopic.empty() )
+          Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+                Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription, 
+                ContextPublisherTopic ), GetSessionLayerAddress() );
+      }
+
+      if( !HistoryDirectory.empty() )
+      {
+        History = std::make_unique< SolutionHistory >( HistoryDirectory );
+
+        if( HasNetwork() )
+        {
+          Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+                Theron::AMQ::NetworkLayer::TopicSubscription::Action::Subscription, 
+                SolutionHistory::Query::AMQTopic ), GetSessionLayerAddress() );
+
+          Send( Theron::AMQ::NetworkLayer::TopicSubscription( 
+                Theron::AMQ::NetworkLayer::TopicSubscription::Action::Publisher, 
+                SolutionHistory::Response::AMQTopic ), GetSessionLayerAddress() );
+        }
+      }
+
+      if( SurrogateConfidence > 0.0 )
+        Surrogate = std::make_unique< SolutionSurrogate >( SurrogateConfidence );
+
+      if( WarmStart )
+        WarmStarts = std::make_unique< SolutionIndex >();
+
+      if( TightenBounds )
+        BoundLearner = std::make_unique< VariableBoundLearner >();
 
       Send( ExecutionControl::StatusMessage(
         ExecutionControl::StatusMessage::State::Started
@@ -298,6 +1316,8 @@ public:
 
     RegisterHandler(this, &SolverManager::HandleApplicationExecutionContext );
     RegisterHandler(this, &SolverManager::PublishSolution );
+    RegisterHandler(this, &SolverManager::HandleHistoryQuery );
+    RegisterHandler(this, &SolverManager::BatchTimeout );
   }
 
   // The destructor closes all the open topics if the network is still open 
@@ -307,6 +1327,8 @@ public:
   {
     if( HasNetwork() )
     {
+      FlushBatches( true );
+
       Send( Theron::AMQ::NetworkLayer::TopicSubscription(
         Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher,
         SolutionReceiver
@@ -316,6 +1338,25 @@ public:
         Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
         ContextTopic
       ), GetSessionLayerAddress() );
+
+      for( const Theron::AMQ::TopicName & TheReplyTopic : ReplyTopics )
+        Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+          Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher,
+          TheReplyTopic
+        ), GetSessionLayerAddress() );
+
+      if( History )
+      {
+        Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+          Theron::AMQ::NetworkLayer::TopicSubscription::Action::CloseSubscription,
+          SolutionHistory::Query::AMQTopic
+        ), GetSessionLayerAddress() );
+
+        Send( Theron::AMQ::NetworkLayer::TopicSubscription(
+          Theron::AMQ::NetworkLayer::TopicSubscription::Action::ClosePublisher,
+          SolutionHistory::Response::AMQTopic
+        ), GetSessionLayerAddress() );
+      }
     }
   }
 
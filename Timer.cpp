@@ -0,0 +1,41 @@
+/*==============================================================================
+Timer
+
+This file implements the waiting of the timer actor. Please see the header
+file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <thread>                                   // Sleeping
+
+#include "Timer.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Waiting
+// --------------------------------------------------------------------------
+//
+
+void Timer::Wait( const WakeUp & TheRequest, const Address TheRequester )
+{
+  std::this_thread::sleep_for( TheRequest.Delay );
+  Send( Timeout( TheRequest.Tag ), TheRequester );
+}
+
+// --------------------------------------------------------------------------
+// Constructor
+// --------------------------------------------------------------------------
+//
+
+Timer::Timer( const std::string & TheActorName )
+: Actor( TheActorName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() )
+{
+  RegisterHandler( this, &Timer::Wait );
+}
+
+} // End name space NebulOuS
@@ -0,0 +1,111 @@
+/*==============================================================================
+Timer
+
+Some actors must act when an expected message does not arrive in time, like
+the Metric Updater waiting for the snapshots of its shards, or when messages
+have been held back for a while, like the solutions collected in a batch. The
+actors only execute when they receive a message, and a timer is therefore an
+actor that sends a timeout message back to the actor that armed it when the
+requested delay has passed. The timer waits on its own thread, and the actor
+arming the timer continues to process its messages in the meantime.
+
+The requests are served in the order they are received, and a request is only
+started when the previous request has timed out. An actor should therefore
+have its own timer and keep at most one request outstanding. The timeout
+carries the tag given with the request so that the actor can recognise the
+timeouts of requests that are no longer relevant.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_TIMER
+#define NEBULOUS_TIMER
+
+// Standard headers
+
+#include <string>                               // Standard strings
+#include <chrono>                               // Delays
+#include <cstdint>                              // Request tags
+
+// Theron++ headers
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Timer
+
+==============================================================================*/
+
+class Timer
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler
+{
+  // --------------------------------------------------------------------------
+  // Messages
+  // --------------------------------------------------------------------------
+  //
+  // The timer is armed with the delay and a tag chosen by the requester, and
+  // the timeout returns the tag when the delay has passed.
+
+public:
+
+  class WakeUp
+  {
+  public:
+
+    const std::chrono::milliseconds Delay;
+    const std::uint64_t             Tag;
+
+    WakeUp( std::chrono::milliseconds TheDelay, std::uint64_t TheTag = 0 )
+    : Delay( TheDelay ), Tag( TheTag )
+    {}
+
+    WakeUp( const WakeUp & Other ) = default;
+    ~WakeUp() = default;
+  };
+
+  class Timeout
+  {
+  public:
+
+    const std::uint64_t Tag;
+
+    Timeout( std::uint64_t TheTag )
+    : Tag( TheTag )
+    {}
+
+    Timeout( const Timeout & Other ) = default;
+    ~Timeout() = default;
+  };
+
+  // --------------------------------------------------------------------------
+  // Waiting
+  // --------------------------------------------------------------------------
+  //
+  // The handler waits for the delay on the thread of the timer before the
+  // timeout is returned to the requester.
+
+private:
+
+  void Wait( const WakeUp & TheRequest, const Address TheRequester );
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+
+public:
+
+  Timer( const std::string & TheActorName );
+  Timer( const Timer & Other ) = delete;
+
+  virtual ~Timer() = default;
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_TIMER
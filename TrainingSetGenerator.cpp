@@ -0,0 +1,376 @@
+/*==============================================================================
+Training Set Generator
+
+This file implements the Training Set Generator actor solving sampled
+application execution contexts and writing the training set file. Please see
+the header file for details.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+// Standard headers
+
+#include <sstream>                                 // Error messages
+#include <stdexcept>                               // Standard exceptions
+#include <source_location>                         // Error locations
+#include <algorithm>                               // Standard algorithms
+#include <charconv>                                // Reading sample indices
+#include <cstdint>                                 // File sizes
+
+#include "Utility/ConsolePrint.hpp"                // For logging
+
+#include "ExecutionControl.hpp"                    // Stopping the component
+#include "BatchRunner.hpp"                         // The problem definition
+#include "TrainingSetGenerator.hpp"
+
+namespace NebulOuS
+{
+// --------------------------------------------------------------------------
+// Training set file
+// --------------------------------------------------------------------------
+//
+// The column names of the header are separated by commas and contain no
+// commas themselves. Rows whose first field is not a sample index, or with 
+// the wrong number of fields, are ignored. A line is only complete if it ends
+// with a newline, and a last line without a newline is the beginning of a row
+// whose writing was interrupted. The file is truncated to remove this line 
+// since the first row appended would otherwise continue it.
+
+void TrainingSetGenerator::ReadExistingSamples( void )
+{
+  std::ifstream  ExistingFile( TrainingSetPath, std::ios::binary );
+  std::string    TheLine;
+  std::uintmax_t CompleteSize = 0;
+
+  auto ReadLine = [&]( void ){
+    if( std::getline( ExistingFile, TheLine ) && !ExistingFile.eof() )
+    {
+      CompleteSize += TheLine.size() + 1;
+      return true;
+    }
+    else
+      return false;
+  };
+
+  if( ReadLine() && !TheLine.empty() )
+  {
+    std::istringstream Header( TheLine );
+    for( std::string TheColumn; std::getline( Header, TheColumn, ',' ); )
+      Columns.push_back( TheColumn );
+
+    while( ReadLine() )
+    {
+      std::size_t TheIndex;
+      auto [ End, Error ] = std::from_chars( TheLine.data(),
+                              TheLine.data() + TheLine.size(), TheIndex );
+
+      if( ( Error == std::errc() ) && ( *End == ',' ) &&
+          ( std::ranges::count( TheLine, ',' ) + 1
+            == static_cast< std::ptrdiff_t >( Columns.size() ) ) )
+        CompletedSamples.insert( TheIndex );
+    }
+  }
+  else
+    CompleteSize = 0;
+
+  ExistingFile.close();
+
+  if( std::filesystem::file_size( TrainingSetPath ) > CompleteSize )
+  {
+    std::filesystem::resize_file( TrainingSetPath, CompleteSize );
+
+    Theron::ConsoleOutput Output;
+    Output << "Training Set Generator: The incomplete last line of " 
+           << TrainingSetPath << " was removed" << std::endl;
+  }
+}
+
+// The settings are stored as a JSON object. A training set without samples
+// can be continued with any settings since no sample index has been used.
+
+void TrainingSetGenerator::CheckSettings( void )
+{
+  std::filesystem::path SettingsPath( TrainingSetPath.string() + ".settings" );
+  JSON TheSettings( Sampler.Settings() );
+
+  if( std::filesystem::exists( SettingsPath ) && !CompletedSamples.empty() )
+  {
+    std::ifstream SettingsFile( SettingsPath );
+    JSON StoredSettings = JSON::parse( SettingsFile, nullptr, false );
+
+    if( StoredSettings != TheSettings )
+    {
+      std::source_location Location = std::source_location::current();
+      std::ostringstream ErrorMessage;
+
+      ErrorMessage << "[" << Location.file_name() << " at line "
+                   << Location.line()
+                   << "in function " << Location.function_name() <<"] "
+                   << "The training set " << TrainingSetPath << " was "
+                   << "generated with the sampler settings " 
+                   << StoredSettings.dump() << " and cannot be continued "
+                   << "with the settings " << TheSettings.dump();
+
+      throw std::invalid_argument( ErrorMessage.str() );
+    }
+  }
+  else if( !CompletedSamples.empty() )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The training set " << TrainingSetPath << " has samples "
+                 << "but no settings file " << SettingsPath << " to check "
+                 << "that the samples are the same";
+
+    throw std::invalid_argument( ErrorMessage.str() );
+  }
+  else
+  {
+    std::ofstream SettingsFile( SettingsPath, std::ios::trunc );
+    SettingsFile << TheSettings.dump( 2 ) << std::endl;
+
+    if( !SettingsFile )
+    {
+      std::source_location Location = std::source_location::current();
+      std::ostringstream ErrorMessage;
+
+      ErrorMessage << "[" << Location.file_name() << " at line "
+                   << Location.line()
+                   << "in function " << Location.function_name() <<"] "
+                   << "The settings file " << SettingsPath 
+                   << " could not be written";
+
+      throw std::runtime_error( ErrorMessage.str() );
+    }
+  }
+}
+
+// The columns are defined by the first solution if the file is new. Values
+// missing from a solution, like the solve time of a failed solution, are left
+// empty, and string values are quoted with embedded quotes doubled.
+
+void TrainingSetGenerator::WriteRow( const JSON & TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  JSON TheRow{ { "Sample",    TheSolution.at( Keys::TimeStamp ) },
+               { "SolveTime", TheSolution.value( Keys::SolveTime, JSON() ) } };
+
+  for( const auto & [ Prefix, TheKey ] : {
+         std::pair{ "Context.",   Keys::ExecutionContext },
+         std::pair{ "Objective.", Keys::ObjectiveValues  },
+         std::pair{ "Variable.",  Keys::VariableValues   } } )
+    if( TheSolution.contains( TheKey ) )
+      for( const auto & [ TheName, TheValue ] : TheSolution.at( TheKey ).items() )
+        TheRow[ Prefix + TheName ] = TheValue;
+
+  if( Columns.empty() )
+  {
+    Columns.push_back( "Sample" );
+
+    for( const auto & TheColumn : TheRow.items() )
+      if( ( TheColumn.key() != "Sample" ) && ( TheColumn.key() != "SolveTime" ) )
+        Columns.push_back( TheColumn.key() );
+
+    Columns.push_back( "SolveTime" );
+
+    for( std::size_t i = 0; i < Columns.size(); i++ )
+      TrainingSet << ( i > 0 ? "," : "" ) << Columns[ i ];
+
+    TrainingSet << '\n';
+  }
+
+  for( std::size_t i = 0; i < Columns.size(); i++ )
+  {
+    const JSON TheValue = TheRow.value( Columns[ i ], JSON() );
+
+    if( i > 0 ) TrainingSet << ',';
+
+    if( TheValue.is_string() )
+    {
+      std::string TheText = TheValue.get< std::string >();
+      std::string::size_type Quote = 0;
+
+      while( ( Quote = TheText.find( '"', Quote ) ) != std::string::npos )
+      {
+        TheText.insert( Quote, 1, '"' );
+        Quote += 2;
+      }
+
+      TrainingSet << '"' << TheText << '"';
+    }
+    else if( !TheValue.is_null() )
+      TrainingSet << TheValue.dump();
+  }
+
+  TrainingSet << std::endl;
+}
+
+// --------------------------------------------------------------------------
+// Samples
+// --------------------------------------------------------------------------
+//
+// The sample index is used as the time stamp of the context so that the
+// samples are solved in order, and as the correlation identifier.
+
+void TrainingSetGenerator::SubmitSamples( void )
+{
+  while( ( OutstandingSamples < Window ) && ( NextSample < Sampler.size() ) )
+  {
+    std::size_t TheIndex = NextSample++;
+
+    if( CompletedSamples.contains( TheIndex ) ) continue;
+
+    Solver::ApplicationExecutionContext TheContext( TheIndex,
+      Sampler.Sample( TheIndex ), false );
+
+    TheContext[ Solver::ApplicationExecutionContext::Keys::CorrelationID ]
+      = std::to_string( TheIndex );
+    TheContext[ Solver::ApplicationExecutionContext::Keys::ReplyTo ]
+      = std::string( Solver::ApplicationExecutionContext::LocalReply )
+      + GetAddress().AsString();
+
+    OutstandingSamples++;
+    Send( TheContext, SolverManager );
+  }
+
+  if( ( OutstandingSamples == 0 ) && ( NextSample >= Sampler.size() ) &&
+      !Stopped )
+  {
+    Stopped = true;
+
+    Theron::ConsoleOutput Output;
+    Output << "Training Set Generator: " << WrittenSamples << " samples "
+           << "written, " << FailedSamples << " samples failed, and " 
+           << CompletedSamples.size() << " samples were already in " 
+           << TrainingSetPath << std::endl;
+
+    Send( ExecutionControl::StopMessage(), SolverManager );
+  }
+}
+
+void TrainingSetGenerator::Start( const StartGeneration & TheCommand,
+                                  const Address Sender )
+{
+  SubmitSamples();
+}
+
+// --------------------------------------------------------------------------
+// Solutions
+// --------------------------------------------------------------------------
+//
+// The solution does not contain the execution context, and the metric values
+// are therefore added from the sample before the row is written.
+
+void TrainingSetGenerator::RecordSolution( const JSON & TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  // The samples do not ask for approximate solutions, but a predicted 
+  // solution is not an exact solution of the sample and it is ignored.
+
+  if( TheSolution.value( Keys::Predicted, false ) ) return;
+
+  OutstandingSamples -= std::min< std::size_t >( OutstandingSamples, 1 );
+
+  if( TheSolution.contains( Keys::Error ) )
+  {
+    FailedSamples++;
+
+    Theron::ConsoleOutput Output;
+    Output << "Training Set Generator: The sample "
+           << TheSolution.value( Keys::CorrelationID, JSON() ).dump()
+           << " failed: " << TheSolution.at( Keys::Error ) << std::endl;
+
+    return;
+  }
+
+  JSON TheRecord( TheSolution );
+  TheRecord[ Keys::ExecutionContext ] = Sampler.Sample(
+    TheSolution.at( Keys::TimeStamp ).get< std::size_t >() );
+
+  WriteRow( TheRecord );
+
+  WrittenSamples++;
+}
+
+void TrainingSetGenerator::ReturnSolution( const Solver::Solution & TheSolution,
+                                           const Address TheSolverManager )
+{
+  RecordSolution( TheSolution );
+  SubmitSamples();
+}
+
+void TrainingSetGenerator::ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                                        const Address TheSolverManager )
+{
+  for( const JSON & TheSolution :
+       TheBatch.at( Solver::SolutionBatch::Keys::Solutions ) )
+    RecordSolution( TheSolution );
+
+  SubmitSamples();
+}
+
+// --------------------------------------------------------------------------
+// Constructor
+// --------------------------------------------------------------------------
+//
+
+TrainingSetGenerator::TrainingSetGenerator(
+  const std::string & TheActorName, const Address & TheSolverManager,
+  const std::string & SolverRootName, unsigned int NumberOfSolvers,
+  const std::filesystem::path & ModelFile,
+  const std::filesystem::path & DataFile,
+  const std::string & ObjectiveFunction,
+  const ContextSampler & TheSampler,
+  const std::filesystem::path & TheTrainingSet )
+: Actor( TheActorName ),
+  StandardFallbackHandler( Actor::GetAddress().AsString() ),
+  TrainingSetPath( TheTrainingSet ), TrainingSet(), Columns(),
+  CompletedSamples(), Sampler( TheSampler ), SolverManager( TheSolverManager ),
+  Window( 2 * std::max( NumberOfSolvers, 1u ) ),
+  NextSample( 0 ), OutstandingSamples( 0 ), WrittenSamples( 0 ), 
+  FailedSamples( 0 ),
+  Stopped( false )
+{
+  if( std::filesystem::exists( TrainingSetPath ) )
+    ReadExistingSamples();
+
+  CheckSettings();
+
+  TrainingSet.open( TrainingSetPath, std::ios::app );
+
+  if( !TrainingSet )
+  {
+    std::source_location Location = std::source_location::current();
+    std::ostringstream ErrorMessage;
+
+    ErrorMessage << "[" << Location.file_name() << " at line "
+                 << Location.line()
+                 << "in function " << Location.function_name() <<"] "
+                 << "The training set file " << TrainingSetPath
+                 << " could not be opened";
+
+    throw std::runtime_error( ErrorMessage.str() );
+  }
+
+  Solver::OptimisationProblem TheProblem( BatchRunner::ProblemMessage(
+    ModelFile, DataFile, ObjectiveFunction ) );
+
+  for( unsigned int i = 1; i <= NumberOfSolvers; i++ )
+    Send( TheProblem, Address( SolverRootName + "_" + std::to_string( i ) ) );
+
+  RegisterHandler( this, &TrainingSetGenerator::Start          );
+  RegisterHandler( this, &TrainingSetGenerator::ReturnSolution );
+  RegisterHandler( this, &TrainingSetGenerator::ReturnBatch    );
+
+  Send( StartGeneration(), GetAddress() );
+}
+
+} // End name space NebulOuS
@@ -0,0 +1,191 @@
+/*==============================================================================
+Training Set Generator
+
+The Solver Manager can be used to produce training sets for the machine
+learning models estimating the application's performance indicators, or the
+change in utility, as a function of the metric values of the application
+execution context. The Training Set Generator produces such a training set
+without an AMQ broker: It loads the model like the Batch Runner, and it then
+samples the application execution contexts over the declared range of each
+metric with the Context Sampler. The samples are solved in parallel by the
+solver pool of the Solver Manager, and each sample is written as one row of a
+comma separated values (CSV) file together with the objective values, the
+variable values and the time used by the solver to find the solution.
+
+The columns of the file are the sample index, the metric values with names
+prefixed by "Context.", the objective values prefixed by "Objective.", the
+variable values prefixed by "Variable.", and the solve time in microseconds.
+The header is written when the first solution is received since the names of
+the objectives and the variables are only known from the solutions. The rows
+are written in the order the solutions are found and the file is flushed for
+each row.
+
+The generation is resumable: If the output file exists, the samples already
+in the file are skipped and the new rows are appended to the file. A last row
+left incomplete by an interrupted generation is removed before new rows are
+appended. The sample indices only identify the same samples if the sampling
+method, the number of samples, the metric ranges and the seed are the same, 
+and these settings are therefore stored in a settings file next to the
+training set file, named as the training set file with the extension
+".settings" added. A generation with other settings than the stored settings 
+is refused.
+
+The samples are submitted to the Solver Manager in a window of twice the
+number of solvers so that the solvers are kept busy without filling the queue
+of the Solver Manager with all samples at once. When all samples have been
+solved, the stop message is sent to the Solver Manager to terminate the
+Solver Component.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_TRAINING_SET_GENERATOR
+#define NEBULOUS_TRAINING_SET_GENERATOR
+
+// Standard headers
+
+#include <string>                               // Standard strings
+#include <vector>                               // Column names
+#include <unordered_set>                        // Completed samples
+#include <filesystem>                           // File paths
+#include <fstream>                              // The training set file
+#include <cstddef>                              // Counters
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// Theron++ headers
+
+#include "Actor.hpp"                            // Actor base class
+#include "Utility/StandardFallbackHandler.hpp"  // Exception unhanded messages
+
+// NebulOuS headers
+
+#include "Solver.hpp"                           // Context and solution messages
+#include "ContextSampler.hpp"                   // The samples
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Training Set Generator
+
+==============================================================================*/
+
+class TrainingSetGenerator
+: virtual public Theron::Actor,
+  virtual public Theron::StandardFallbackHandler
+{
+  // --------------------------------------------------------------------------
+  // Training set file
+  // --------------------------------------------------------------------------
+  //
+  // The columns are read from the header of an existing file or defined from
+  // the first solution, and the indices of the samples already written are
+  // read from the first column of an existing file. The file is truncated 
+  // after the last complete line.
+
+private:
+
+  const std::filesystem::path TrainingSetPath;
+  std::ofstream               TrainingSet;
+  std::vector< std::string >  Columns;
+  std::unordered_set< std::size_t > CompletedSamples;
+
+  void ReadExistingSamples( void );
+
+  // The settings of the sampler are compared with the settings stored for an
+  // existing training set, and an invalid argument exception is thrown if 
+  // they differ or if the file has samples but no stored settings. The 
+  // settings are stored if there are no stored settings.
+
+  void CheckSettings( void );
+
+  // A row is written with the values of the columns, and values that are
+  // strings are quoted.
+
+  void WriteRow( const JSON & TheSolution );
+
+  // --------------------------------------------------------------------------
+  // Samples
+  // --------------------------------------------------------------------------
+  //
+  // The samples are submitted from the next sample index, skipping samples
+  // already in the file, until the window of outstanding samples is full.
+
+  const ContextSampler Sampler;
+  const Address        SolverManager;
+  const std::size_t    Window;
+
+  std::size_t NextSample, OutstandingSamples, WrittenSamples, FailedSamples;
+  bool        Stopped;
+
+  void SubmitSamples( void );
+
+  // The submission starts when the actor receives the start message sent by
+  // the constructor so that all submissions are made by the actor's thread.
+
+  class StartGeneration
+  {
+  public:
+
+    StartGeneration( void ) = default;
+    StartGeneration( const StartGeneration & Other ) = default;
+    ~StartGeneration() = default;
+  };
+
+  void Start( const StartGeneration & TheCommand, const Address Sender );
+
+  // --------------------------------------------------------------------------
+  // Solutions
+  // --------------------------------------------------------------------------
+  //
+  // Each solution is written as a row, and a new sample is submitted for each
+  // solution received. Batches of solutions are split into their solutions.
+  // A failed sample is reported and counted, but no row is written for it, 
+  // and the sample is therefore tried again if the generation is resumed.
+
+  void RecordSolution( const JSON & TheSolution );
+
+  void ReturnSolution( const Solver::Solution & TheSolution,
+                       const Address TheSolverManager );
+
+  void ReturnBatch( const Solver::SolutionBatch & TheBatch,
+                    const Address TheSolverManager );
+
+  // --------------------------------------------------------------------------
+  // Constructor and destructor
+  // --------------------------------------------------------------------------
+  //
+  // The constructor takes the name of the actor, the address of the Solver
+  // Manager, the root name and the number of the solvers in the pool, the
+  // model file, the optional data file, and the default objective function
+  // like the Batch Runner. Then follows the sampler for the contexts and the
+  // path of the training set file. The problem is defined for the solvers by
+  // the constructor, and a runtime error is thrown if the training set file
+  // cannot be opened, or an invalid argument exception if the existing file
+  // was generated with other sampler settings.
+
+public:
+
+  TrainingSetGenerator( const std::string & TheActorName,
+                        const Address & TheSolverManager,
+                        const std::string & SolverRootName,
+                        unsigned int NumberOfSolvers,
+                        const std::filesystem::path & ModelFile,
+                        const std::filesystem::path & DataFile,
+                        const std::string & ObjectiveFunction,
+                        const ContextSampler & TheSampler,
+                        const std::filesystem::path & TheTrainingSet );
+
+  TrainingSetGenerator( const TrainingSetGenerator & Other ) = delete;
+
+  virtual ~TrainingSetGenerator() = default;
+};
+
+}       // Name space NebulOuS
+#endif  // NEBULOUS_TRAINING_SET_GENERATOR
@@ -0,0 +1,96 @@
+/*==============================================================================
+Variable Bound Learner
+
+This file implements the learning of the ranges of the optimal variable
+values and the widened bounds offered to the solvers.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#include <cmath>                  // Rounding bounds
+#include <algorithm>              // Minimum and maximum
+
+#include "VariableBoundLearner.hpp"
+
+namespace NebulOuS
+{
+// -----------------------------------------------------------------------------
+// Learning
+// -----------------------------------------------------------------------------
+//
+// A variable first seen after the bounds are offered gets bounds only from
+// the solutions where it was seen, and this is accepted since the solver falls
+// back to the declared bounds if the tightened bounds are wrong.
+
+void VariableBoundLearner::Learn( const Solver::Solution & TheSolution )
+{
+  using Keys = Solver::Solution::Keys;
+
+  if( !TheSolution.contains( Keys::VariableValues ) || 
+      !TheSolution.Solved() ) return;
+
+  JSON TheVersion = TheSolution.value( Keys::ModelVersion, JSON() );
+
+  if( TheVersion != ModelVersion )
+  {
+    Ranges.clear();
+    Observations = 0;
+    ModelVersion = TheVersion;
+  }
+
+  for( const auto & [ TheVariable, TheValue ] :
+       TheSolution.at( Keys::VariableValues ).items() )
+    if( TheValue.is_number() )
+    {
+      double Value    = TheValue.get< double >();
+      bool   Integral = ( Value == std::round( Value ) );
+
+      auto [ TheRange, NewRange ] = Ranges.try_emplace( TheVariable,
+                                      Range{ Value, Value, Integral } );
+
+      if( !NewRange )
+      {
+        TheRange->second.Lower    = std::min( TheRange->second.Lower, Value );
+        TheRange->second.Upper    = std::max( TheRange->second.Upper, Value );
+        TheRange->second.Integral = TheRange->second.Integral && Integral;
+      }
+    }
+
+  Observations++;
+}
+
+// -----------------------------------------------------------------------------
+// Bounds
+// -----------------------------------------------------------------------------
+//
+// The margin makes sure that the observed optimal values are strictly inside
+// the tightened bounds so that a solution on a tightened bound indicates that
+// the bound was too tight.
+
+Solver::MetricValueType VariableBoundLearner::Bounds( void ) const
+{
+  Solver::MetricValueType TheBounds;
+
+  if( Observations < MinObservations ) return TheBounds;
+
+  for( const auto & [ TheVariable, TheRange ] : Ranges )
+  {
+    double Delta = Margin * std::max( TheRange.Upper - TheRange.Lower, 1.0 ),
+           Lower = TheRange.Lower - Delta,
+           Upper = TheRange.Upper + Delta;
+
+    if( TheRange.Integral )
+    {
+      Lower = std::floor( Lower );
+      Upper = std::ceil( Upper );
+    }
+
+    TheBounds.emplace( TheVariable, JSON::array({ Lower, Upper }) );
+  }
+
+  return TheBounds;
+}
+
+}      // namespace NebulOuS
@@ -0,0 +1,105 @@
+/*==============================================================================
+Variable Bound Learner
+
+The time used by spatial branch-and-bound solvers for nonconvex problems, like
+Couenne, depends strongly on the bounds of the variables since the convex
+relaxations of the problem become tighter when the domains of the variables
+are smaller. The bounds declared in the model must cover every possible
+application execution context, but the optimal values of the variables are
+often found in a much smaller part of the declared domain. The Variable Bound
+Learner records the range of the optimal value of each variable over the
+solutions found for the current version of the model, and when enough
+solutions have been seen, it offers bounds widened by a margin around this
+empirical range. The solver will then solve the problem with the tightened
+bounds and fall back to the declared bounds if the tightened problem has no
+solution or if the solution is on a tightened bound, since the true optimum
+may then be outside of the tightened bounds.
+
+The margin is a fraction of the width of the range, or of one if the range is
+narrower than one, and the bounds of variables whose optimal values have all
+been integral are rounded outwards to integers. All ranges are forgotten when
+a solution from a new version of the optimisation model is learned.
+
+Author and Copyright: Geir Horn, University of Oslo
+Contact: Geir.Horn@mn.uio.no
+License: MPL2.0 (https://www.mozilla.org/en-US/MPL/2.0/)
+==============================================================================*/
+
+#ifndef NEBULOUS_VARIABLE_BOUND_LEARNER
+#define NEBULOUS_VARIABLE_BOUND_LEARNER
+
+// Standard headers
+
+#include <string>                               // Normal strings
+#include <unordered_map>                        // Ranges by variable
+#include <cstddef>                              // Counters
+
+// Other packages
+
+#include <nlohmann/json.hpp>                    // JSON object definition
+using JSON = nlohmann::json;                    // Short form name space
+
+// NebulOuS headers
+
+#include "Solver.hpp"                            // Solution and contexts
+
+namespace NebulOuS
+{
+/*==============================================================================
+
+ Variable Bound Learner
+
+==============================================================================*/
+
+class VariableBoundLearner
+{
+  // The range of a variable is the smallest and the largest optimal value
+  // seen, and whether all values seen have been integral.
+
+private:
+
+  struct Range
+  {
+    double Lower, Upper;
+    bool   Integral;
+  };
+
+  std::unordered_map< std::string, Range > Ranges;
+  std::size_t Observations;
+  JSON        ModelVersion;
+
+  // The parameters are the number of solutions needed before bounds are
+  // offered and the margin added on each side of the range.
+
+  const std::size_t MinObservations;
+  const double      Margin;
+
+public:
+
+  // The solutions are learned from their numerical variable values. Solves
+  // that failed, or ended infeasible or at a limit, are ignored since their
+  // variable values are not optimal.
+
+  void Learn( const Solver::Solution & TheSolution );
+
+  // The bounds are returned as a map from the variable names to an array
+  // with the lower and the upper bound. The map is empty if there are not
+  // yet enough solutions seen for the current model version.
+
+  Solver::MetricValueType Bounds( void ) const;
+
+  // The constructor takes the number of solutions needed before the bounds
+  // are offered and the margin as a fraction of the width of the range.
+
+  VariableBoundLearner( std::size_t RequiredSolutions = 50,
+                        double RangeMargin = 0.25 )
+  : Ranges(), Observations( 0 ), ModelVersion(),
+    MinObservations( RequiredSolutions ), Margin( RangeMargin )
+  {}
+
+  VariableBoundLearner( const VariableBoundLearner & Other ) = delete;
+  ~VariableBoundLearner() = default;
+};
+
+}      // namespace NebulOuS
+#endif // NEBULOUS_VARIABLE_BOUND_LEARNER